@@ -1,168 +1,166 @@
 #ifndef GAME_ENGINE_H
 #define GAME_ENGINE_H
-#include "game/Player.h"
-#include "game/EntityManager.h"
-#include "game/WeaponSystem.h"
-#include "game/Map.h"
+#include "game/World.h"
+#include "game/Replay.h"
+#include "render/SceneRenderer.h"
+
+// A world of mode M (see WorldMode.h) plus its rendering; GameEngine is the
+// standard mode the app plays.
+template<class M>
+class BasicGameEngine {
+public:
+    typedef BasicWorld<M> WorldType;
 
-class GameEngine {
+private:
+    RenderDevice* device; // not owned
     Shader* shader;
-    Player* player;
-    WeaponSystem* weapons;
-    EntityManager* entities;
-    Map* map;
-    
+    WorldType* world;
+    Random fxRng; // cosmetic only, kept out of the simulation stream
+    SceneRenderer renderer;
+    InputRecorder* recorder; // not owned; NULL when not recording
+
     Mat4 projMat, viewMat;
     float screenW, screenH;
-    int gameState;
-    
-    float zoneRadius;
-    float cameraShake;
-    float slowMoTimer;
-    
-    float lastDt; // Store for input synchronization
 
 public:
-    GameEngine() {
-        shader = new Shader(); 
-        player = new Player(); 
-        weapons = new WeaponSystem(); 
-        entities = new EntityManager(); 
-        map = new Map();
-        lastDt = 0.016f;
-        reset();
-    }
-    
-    ~GameEngine() { delete shader; delete player; delete weapons; delete entities; delete map; }
-
-    void reset() {
-        if(player) player->reset();
-        if(entities) entities->reset();
-        if(map) map->generateDerb();
-        if(entities) entities->spawnBots(30);
-        gameState = 0;
-        zoneRadius = GameConfig::ZONE_START_RADIUS;
-        cameraShake = 0.0f;
-        slowMoTimer = 0.0f;
+    BasicGameEngine(RenderDevice* dev, uint64_t seed = 1) : device(dev), fxRng(seed ^ 0x5EEDull), recorder(NULL) {
+        shader = new Shader();
+        world = new WorldType(seed);
     }
 
-    void init() { 
-        shader->init(); 
-        glEnable(GL_DEPTH_TEST); 
-        glEnable(GL_BLEND); 
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); 
-        glClearColor(0.1f, 0.1f, 0.2f, 1.0f); 
+    ~BasicGameEngine() { delete shader; delete world; }
+
+    void reset() { stopRecording(); world->reset(); }
+    void reset(uint64_t seed) { stopRecording(); world->reset(seed); }
+    uint64_t getSeed() { return world->seed; }
+
+    // Call on every new GL context. `programs` (optional) caches the
+    // linked shader between launches. False if the shader failed to build;
+    // getShaderError() has the driver log.
+    bool init(ProgramCache* programs = NULL) {
+        device->invalidateState();
+        if(!shader->init(device, programs)) return false;
+        renderer.init(shader);
+        device->setupState(0.1f, 0.1f, 0.2f);
+        return true;
     }
-    
+
+    const std::string& getShaderError() { return shader->error; }
+    bool shaderFromCache() { return shader->fromCache; }
+
     void resize(int w, int h) {
-        if (h == 0) h = 1; 
-        screenW=(float)w; screenH=(float)h; glViewport(0,0,w,h);
+        if (h == 0) h = 1;
+        screenW=(float)w; screenH=(float)h; device->viewport(w, h);
         float aspect=screenW/screenH; Mat4::perspective(projMat, 1.0f, aspect, 1.0f, 100.0f);
     }
 
+    // The stick is quantized the same way whether or not a recorder is
+    // attached, so recorded sessions play exactly like unrecorded ones.
     void input(float jx, float jy, bool fire, bool dash, bool ult) {
-        if(gameState != 0) return;
-        
-        if(jx>1.0f) jx=1.0f; if(jx<-1.0f) jx=-1.0f;
-        if(jy>1.0f) jy=1.0f; if(jy<-1.0f) jy=-1.0f;
-        
-        Vec3 moveDir(jx, 0, jy);
-        if(moveDir.length() > 0.01f) {
-            // FIX: Use lastDt for sync
-            Vec3 nextPos = player->pos + (moveDir * player->currentSpeed * lastDt);
-            if (!map->checkCollision(nextPos, 1.0f)) {
-                player->pos = nextPos;
-                player->setInput(jx, jy);
-            }
-        }
-        
-        if(dash) { player->triggerDash(); cameraShake = 0.3f; }
-        if(ult) { player->triggerUlt(); cameraShake = 0.5f; }
-        
-        if(fire && player->fireTimer <= 0.0f) {
-            Vec3 dir = moveDir; 
-            if(dir.length() < 0.1f) dir = Vec3(0,0,-1); else dir.normalize();
-            
-            WeaponType wType = WeaponType::PISTOL; 
-            if (player->ultActive) wType = WeaponType::BEAM;
-            
-            weapons->fire(player->pos, dir, true, wType);
-            player->fireTimer = (wType==WeaponType::BEAM) ? 0.1f : 0.3f;
-            cameraShake = 0.1f;
-        }
+        int qx = InputRecorder::quantizeStick(jx), qy = InputRecorder::quantizeStick(jy);
+        if(recorder) recorder->input(qx, qy, fire, dash, ult);
+        world->input(InputRecorder::stickValue(qx), InputRecorder::stickValue(qy), fire, dash, ult);
+    }
+    void setSimRate(int hz) { world->setSimRate(hz); }
+
+    // Restarts the current match and records it into `r` until
+    // stopRecording() or the next reset.
+    void startRecording(InputRecorder* r) {
+        world->reset(world->seed);
+        recorder = r;
+        r->begin(*world);
+        world->tickListener = r;
     }
 
-    void step(float dt) {
-        if(dt > 0.1f) dt = 0.1f; 
-        if(dt < 0.001f) dt = 0.001f; 
+    void stopRecording() {
+        if(!recorder) return;
+        world->tickListener = NULL;
+        recorder = NULL;
+    }
 
-        float realDt = dt;
-        lastDt = dt; // Store for Input Sync
+    // The match plus the cosmetic rng, so a resumed session draws the same
+    // camera shake too.
+    void saveSnapshot(ByteWriter& w) const {
+        world->save(w);
+        fxRng.save(w);
+    }
 
-        if (slowMoTimer > 0.0f) {
-            dt *= 0.2f; 
-            slowMoTimer = fmax(0.0f, slowMoTimer - realDt);
-        }
+    bool saveSnapshot(const char* path) const {
+        ByteWriter w;
+        saveSnapshot(w);
+        return w.save(path);
+    }
 
-        if (gameState == 0) {
-            if(zoneRadius > GameConfig::ZONE_MIN_RADIUS) zoneRadius -= GameConfig::ZONE_SHRINK_SPEED * dt;
-            if(player->pos.length() > zoneRadius) player->takeDamage(GameConfig::ZONE_DMG * dt);
-
-            player->update(dt);
-            weapons->update(dt);
-            entities->update(dt, map, player, weapons);
-
-            if (player->isDead) gameState = 2;
-            else if (entities->botsAlive == 0) gameState = 1;
-            
-            if (entities->eventKill) slowMoTimer = 0.2f;
-            if (entities->eventBossKill) {
-                slowMoTimer = 1.0f; 
-                cameraShake = 1.0f;
-                entities->eventBossKill = false; 
-            }
+    // Stops any recording: its input stream can't cover a jump in state.
+    bool restoreSnapshot(const uint8_t* data, size_t n, const char** error = NULL) {
+        stopRecording();
+        ByteReader r(data, n);
+        if(!world->load(r, error)) return false;
+        fxRng.load(r);
+        if(!r.ok || r.remaining() != 0) {
+            if(error) *error = "trailing or missing bytes";
+            world->reset(world->seed);
+            return false;
         }
+        return true;
+    }
 
-        if (cameraShake > 0.0f) cameraShake = fmax(0.0f, cameraShake - realDt);
-        
-        float shakeX = ((rand()%200 - 100)/5000.0f) * (cameraShake * 10.0f);
-        float shakeZ = ((rand()%200 - 100)/5000.0f) * (cameraShake * 10.0f);
+    // One read of the whole file, then an in-place restore.
+    bool restoreSnapshot(const char* path, const char** error = NULL) {
+        std::vector<uint8_t> data;
+        if(!readFile(path, data)) { if(error) *error = "cannot read file"; return false; }
+        return restoreSnapshot(data.data(), data.size(), error);
+    }
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Advances the simulation by whatever fixed ticks dt covers, then draws
+    // one frame interpolated between the last two ticks. Returns ticks run.
+    int step(float dt) {
+        Profiler::get().beginFrame();
+        PROFILE_ZONE(PZ_FRAME);
+        uint32_t dtMicros = InputRecorder::quantizeDt(dt);
+        if(recorder) recorder->step(dtMicros);
+        int ticks = world->advance(InputRecorder::dtValue(dtMicros));
+        float t = world->interpAlpha;
+
+        Player* player = world->player;
+        float cameraShake = world->cameraShake;
+        float shakeX = ((fxRng.range(200) - 100)/5000.0f) * (cameraShake * 10.0f);
+        float shakeZ = ((fxRng.range(200) - 100)/5000.0f) * (cameraShake * 10.0f);
+
+        device->beginFrame();
+        device->clear();
         shader->use();
 
-        Vec3 camPos = player->pos + Vec3(shakeX, 25, 18 + shakeZ); 
-        Mat4::lookAt(viewMat, camPos, player->pos, Vec3(0,1,0));
+        Vec3 focus = player->renderPos(t);
+        Vec3 camPos = focus + Vec3(shakeX, 25, 18 + shakeZ);
+        Mat4::lookAt(viewMat, camPos, focus, Vec3(0,1,0));
         Mat4 vp; Mat4::multiply(vp, projMat, viewMat);
-        
-        GameObject wall; wall.scaleV = Vec3(4, 4, 4); wall.color = Vec3(0.4f, 0.4f, 0.5f); wall.isActive = true;
-        for(auto& w : map->walls) { 
-            float distSq = (w.x - player->pos.x)*(w.x - player->pos.x) + (w.z - player->pos.z)*(w.z - player->pos.z);
-            if(distSq < GameConfig::WALL_CULL_SQ) { 
-                wall.pos=w; wall.draw(shader, vp); 
-            } 
-        }
 
-        player->drawAura(shader, vp);
-        player->draw(shader, vp);
-        entities->draw(shader, vp);
-        weapons->draw(shader, vp);
+        renderer.drawWorld(shader, world, vp);
+        return ticks;
     }
-    
-    bool consumeKillEvent() { return entities->consumeKillEvent(); }
-    bool consumeShootEvent() { return weapons->consumeShootEvent(); }
-    int getBotsAlive() { return entities->botsAlive; }
-    int getHP() { return (int)player->hp; }
-    int getState() { return gameState; }
-    float getUltProgress() { 
+
+    WorldType* getWorld() { return world; }
+    const FrameStats& getFrameStats() { return device->frame; }
+    const CullStats& getCullStats() { return renderer.cull; }
+
+    bool consumeKillEvent() { return world->entities->consumeKillEvent(); }
+    bool consumeShootEvent() { return world->weapons->consumeShootEvent(); }
+    int getBotsAlive() { return world->entities->botsAlive; }
+    int getHP() { return (int)world->player->hp; }
+    int getState() { return world->gameState; }
+    float getUltProgress() {
+        Player* player = world->player;
         if (player->ultCooldown <= 0.0f) return 1.0f;
-        float prog = 1.0f - (player->ultCooldown / GameConfig::ULT_COOLDOWN); 
-        if(prog < 0.0f) prog = 0.0f; if(prog > 1.0f) prog = 1.0f; 
+        float prog = 1.0f - (player->ultCooldown / GameConfig::ULT_COOLDOWN);
+        if(prog < 0.0f) prog = 0.0f;
+        if(prog > 1.0f) prog = 1.0f;
         return prog;
     }
-    bool isUltActive() { return player->ultActive; }
-    bool hasKillFeed() { return entities->killFeed.active; }
-    float getKillFeedAlpha() { return entities->killFeed.alpha; }
+    bool isUltActive() { return world->player->ultActive; }
+    bool hasKillFeed() { return world->entities->killFeed.active; }
+    float getKillFeedAlpha() { return world->entities->killFeed.alpha; }
 };
-#endif
 
+typedef BasicGameEngine<StandardMode> GameEngine;
+#endif
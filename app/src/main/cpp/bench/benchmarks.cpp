@@ -0,0 +1,787 @@
+// Engine hot-path benchmarks. Builds on Linux against sim-core only.
+//
+// Output is JSON Lines so runs from two commits can be diffed by script.
+// The first line describes the build; every other line is one case:
+//   {"bench":"map","case":"check_collision","params":{...},"samples":S,
+//    "ops_per_sample":K,"ns_per_op":{"mean":..,"min":..,"p50":..,"p90":..,
+//    "p99":..,"max":..},"metrics":{...}}
+// Each sample times K back-to-back ops, so ops shorter than the clock's
+// resolution average out while the percentiles still show jitter between
+// samples. "metrics" carries derived rates, checksums and correctness
+// counts (mismatches, tunnels) that must stay at zero.
+//
+// Usage: benchmarks [filter]  runs the suites whose name contains filter.
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include "GameEngine.h"
+#include "game/World.h"
+#include "render/RecordingDevice.h"
+#include "tools/Pilot.h"
+
+typedef std::chrono::steady_clock BenchClock;
+
+// Every heap allocation the process makes, so a case can report how many
+// its timed ops did.
+static std::atomic<long long> heapAllocs(0);
+
+void* operator new(size_t bytes) {
+    heapAllocs.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(bytes ? bytes : 1);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+// Out of line so GCC doesn't pair the inlined free() with operator new.
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+static double secondsSince(BenchClock::time_point start) {
+    return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+// Comma-separated JSON members, built up one key at a time.
+struct JsonFields {
+    std::string body;
+
+    JsonFields& num(const char* key, double v) {
+        char buf[96];
+        if(isfinite(v)) snprintf(buf, sizeof(buf), "%s\"%s\":%.6g", body.empty() ? "" : ",", key, v);
+        else snprintf(buf, sizeof(buf), "%s\"%s\":null", body.empty() ? "" : ",", key);
+        body += buf;
+        return *this;
+    }
+
+    JsonFields& str(const char* key, const char* v) {
+        body += body.empty() ? "\"" : ",\"";
+        body += key;
+        body += "\":\"";
+        for(const char* c = v; *c; c++) {
+            if(*c == '"' || *c == '\\') body += '\\';
+            body += *c;
+        }
+        body += '"';
+        return *this;
+    }
+
+    std::string object() const { return "{" + body + "}"; }
+};
+
+// Nearest-rank percentile of an ascending vector.
+static double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = (size_t)ceil(p * sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// Runs `samples` samples of `opsPerSample` calls to op(k), k counting up
+// across the whole run, and returns ns per op for each sample.
+// prepare() runs untimed before every sample.
+template<class Op, class Prepare>
+static std::vector<double> sample(int samples, int opsPerSample, Op op, Prepare prepare) {
+    std::vector<double> ns(samples);
+    int k = 0;
+    for(int s=0; s<samples; s++) {
+        prepare();
+        auto start = BenchClock::now();
+        for(int o=0; o<opsPerSample; o++) op(k++);
+        ns[s] = secondsSince(start) * 1e9 / opsPerSample;
+    }
+    return ns;
+}
+
+template<class Op>
+static std::vector<double> sample(int samples, int opsPerSample, Op op) {
+    return sample(samples, opsPerSample, op, []{});
+}
+
+// Prints one result line and returns the sample median.
+static double report(const char* bench, const char* name, const JsonFields& params,
+                     int opsPerSample, std::vector<double> ns, const JsonFields& metrics) {
+    std::sort(ns.begin(), ns.end());
+    double sum = 0.0;
+    for(double v : ns) sum += v;
+    JsonFields stats;
+    stats.num("mean", sum / ns.size()).num("min", ns.front()).num("p50", percentile(ns, 0.5))
+         .num("p90", percentile(ns, 0.9)).num("p99", percentile(ns, 0.99)).num("max", ns.back());
+    JsonFields line;
+    line.str("bench", bench).str("case", name);
+    printf("{%s,\"params\":%s,\"samples\":%d,\"ops_per_sample\":%d,\"ns_per_op\":%s,\"metrics\":%s}\n",
+           line.body.c_str(), params.object().c_str(), (int)ns.size(), opsPerSample,
+           stats.object().c_str(), metrics.object().c_str());
+    fflush(stdout);
+    return percentile(ns, 0.5);
+}
+
+static void reportMeta() {
+#if defined(SIMD_SSE2)
+    const char* simd = "sse2";
+#elif defined(SIMD_NEON)
+    const char* simd = "neon";
+#else
+    const char* simd = "scalar";
+#endif
+    JsonFields meta;
+    meta.str("simd", simd).num("hw_threads", std::thread::hardware_concurrency());
+#ifdef __VERSION__
+    meta.str("compiler", __VERSION__);
+#endif
+#ifdef NDEBUG
+    meta.str("asserts", "off");
+#else
+    meta.str("asserts", "on");
+#endif
+    printf("{\"meta\":%s}\n", meta.object().c_str());
+}
+
+static void scaleSamples(std::vector<double>& ns, double divisor) {
+    for(double& v : ns) v /= divisor;
+}
+
+// EntityManager::update (grid rebuild, target acquisition with line of
+// sight, movement, bullet collision) with `botCount` live bots packed into
+// the usual spawn area; one op is one tick. ns per bot should stay roughly
+// flat as the count grows. With threads > 1 the AI phase runs on a
+// JobSystem of that size. Bullets are integrated between samples so the
+// pool holds a steady-state load rather than growing without bound.
+static void benchBotAI(int botCount, int ticks, int threads, bool lod) {
+    Random rng(42);
+    Map map;
+    map.generateDerb(rng);
+    Player player;
+    WeaponSystem weapons;
+    EntityManager em(&rng);
+    em.spawnBots(botCount);
+    JobSystem jobs(threads);
+    if(threads > 1) em.jobs = &jobs;
+    em.aiLod = lod;
+
+    const float dt = 1.0f / 60.0f;
+    for(int i=0; i<10; i++) { em.update(dt, &map, &player, &weapons); weapons.update(dt); }
+
+    long long rays = 0, cached = 0;
+    std::vector<double> ns = sample(ticks, 1, [&](int) {
+        em.update(dt, &map, &player, &weapons);
+    }, [&] {
+        player.hp = player.maxHp; player.isDead = false;
+        weapons.update(dt);
+        rays += em.aiStats.losRays; cached += em.aiStats.losCached;
+    });
+
+    const AiStats& ls = em.aiStats;
+    JsonFields params, metrics;
+    params.num("bots", botCount).num("threads", threads).num("lod", lod ? 1 : 0);
+    std::vector<double> sorted = ns;
+    std::sort(sorted.begin(), sorted.end());
+    metrics.num("ns_per_bot_p50", percentile(sorted, 0.5) / botCount)
+           .num("full", ls.bots[AI_FULL]).num("mid", ls.bots[AI_MID]).num("far", ls.bots[AI_FAR])
+           .num("los_rays_per_tick", (double)rays / ticks).num("los_cached_per_tick", (double)cached / ticks)
+           .num("bullets", weapons.bullets.count());
+    report("bot_ai", "entity_update", params, 1, ns, metrics);
+}
+
+// Bullet resolution under saturation: a pool of `bulletCount` live bullets,
+// half the player's, scattered around `botCount` bots and the player, all
+// resolved in one collideBullets call. Bots and player can't die, and the
+// pool is refilled before every sample, so each op sees the same load.
+static void benchBullets(int botCount, int bulletCount, int samples) {
+    Random rng(13);
+    EntityManager em(&rng);
+    em.spawnBots(botCount);
+    for(int i : em.botSlots.dense) em.bots[i].hp = em.bots[i].maxHp = 1e9f;
+    Player player;
+    player.hp = player.maxHp = 1e9f;
+    WeaponSystem weapons;
+
+    std::vector<Vec3> at(bulletCount);
+    for(int k=0; k<bulletCount; k++) {
+        if(k & 1) {
+            const Bot& b = em.bots[em.botSlots.dense[rng.range((int)em.botSlots.dense.size())]];
+            at[k] = b.pos + Vec3(rng.unit() * 8 - 4, 0, rng.unit() * 8 - 4);
+        } else {
+            at[k] = Vec3(rng.unit() * 16 - 8, 0, rng.unit() * 16 - 8);
+        }
+    }
+    auto refill = [&] {
+        weapons.bullets.clear();
+        em.particles.clear();
+        for(int k=0; k<bulletCount; k++) weapons.bullets.spawn(at[k], Vec3(1, 0, 0), (k & 1) != 0, WeaponType::PISTOL);
+    };
+
+    long long hits = 0;
+    bool first = true;
+    std::vector<double> ns = sample(samples, 1, [&](int) {
+        em.collideBullets(&player, &weapons);
+    }, [&] {
+        if(!first) hits += bulletCount - weapons.bullets.count();
+        first = false;
+        refill();
+    });
+    hits += bulletCount - weapons.bullets.count();
+
+    JsonFields params, metrics;
+    params.num("bots", botCount).num("bullets", bulletCount);
+    std::vector<double> sorted = ns;
+    std::sort(sorted.begin(), sorted.end());
+    metrics.num("ns_per_bullet_p50", percentile(sorted, 0.5) / bulletCount).num("hits_per_op", (double)hits / samples);
+    report("bullets", "collide", params, 1, ns, metrics);
+}
+
+// Projectile/particle integration: the vectorized kernel against the scalar
+// reference over `lanes` SoA slots; one op integrates every lane once.
+static void benchIntegrate(int lanes, int samples, int opsPerSample) {
+    KinematicPool pool;
+    pool.resize(lanes);
+    Random rng(7);
+    for(int i=0; i<lanes; i++) {
+        pool.place(pool.acquire(), Vec3(0,0,0), Vec3(rng.unit(), rng.unit(), rng.unit()), 1e9f);
+    }
+    const int n = (int)pool.px.size();
+
+    JsonFields params;
+    params.num("lanes", lanes);
+    std::vector<double> ns = sample(samples, opsPerSample, [&](int) {
+        Simd::integrateScalar(pool.px.data(), pool.py.data(), pool.pz.data(),
+                              pool.vx.data(), pool.vy.data(), pool.vz.data(), pool.life.data(), n, 0.016f);
+    });
+    double scalarNs = report("integrate", "scalar", params, opsPerSample, ns, JsonFields().num("checksum", pool.px[lanes - 1]));
+    ns = sample(samples, opsPerSample, [&](int) {
+        Simd::integrate(pool.px.data(), pool.py.data(), pool.pz.data(),
+                        pool.vx.data(), pool.vy.data(), pool.vz.data(), pool.life.data(), n, 0.016f);
+    });
+    JsonFields metrics;
+    metrics.num("checksum", pool.px[lanes - 1]);
+    std::vector<double> sorted = ns;
+    std::sort(sorted.begin(), sorted.end());
+    metrics.num("speedup_p50", scalarNs / percentile(sorted, 0.5));
+    report("integrate", "simd", params, opsPerSample, ns, metrics);
+}
+
+// Particle ring: a boss-kill burst of `burst` as one reservation against
+// the same particles spawned one at a time. Ops are bursts; the ring is
+// emptied before every sample.
+static void benchParticleSpawn(int burst, int samples) {
+    Random rng(17);
+    EntityManager em(&rng);
+    const int bursts = 64;
+    JsonFields params;
+    params.num("burst", burst);
+    std::vector<double> ns = sample(samples, bursts, [&](int) {
+        for(int k=0; k<burst; k++) em.spawnEffect(Vec3(0, 0, 0), EMIT_BOSS_KILL);
+    }, [&] { em.particles.clear(); });
+    double singleNs = report("particles", "spawn_single", params, bursts, ns, JsonFields().num("capacity", em.particles.capacity()));
+    ns = sample(samples, bursts, [&](int) {
+        em.spawnBurst(Vec3(0, 0, 0), EMIT_BOSS_KILL, burst);
+    }, [&] { em.particles.clear(); });
+    std::vector<double> sorted = ns;
+    std::sort(sorted.begin(), sorted.end());
+    report("particles", "spawn_burst", params, bursts, ns,
+           JsonFields().num("ns_per_particle_p50", percentile(sorted, 0.5) / burst).num("speedup_p50", singleNs / percentile(sorted, 0.5)));
+}
+
+// One particle-ring update of `live` particles on 1 thread and on every
+// hardware thread. The live range starts mid-ring, so it wraps.
+static void benchParticleUpdate(int live, int samples) {
+    Random rng(19);
+    ParticleSystem parts;
+    parts.resize(live);
+    parts.head = parts.tail = (uint32_t)(parts.capacity() - live / 2);
+    uint32_t first = parts.reserve(live);
+    for(int k=0; k<live; k++) {
+        int i = parts.lane(first + k);
+        parts.place(i, Vec3(0, 0, 0), Vec3(rng.unit(), rng.unit(), rng.unit()), EMIT_HIT);
+        parts.life[i] = 1e9f;
+    }
+    int hw = (int)std::thread::hardware_concurrency();
+    int threadCounts[] = { 1, hw > 1 ? hw : 1 };
+    double oneNs = 0.0;
+    for(int c=0; c<(hw > 1 ? 2 : 1); c++) {
+        JobSystem jobs(threadCounts[c]);
+        JsonFields up;
+        up.num("live", live).num("threads", threadCounts[c]);
+        std::vector<double> ns = sample(samples, 10, [&](int) { parts.update(0.016f, &jobs); });
+        std::vector<double> sorted = ns;
+        std::sort(sorted.begin(), sorted.end());
+        if(c == 0) oneNs = percentile(sorted, 0.5);
+        JsonFields metrics;
+        metrics.num("ns_per_particle_p50", percentile(sorted, 0.5) / live).num("speedup_p50", oneNs / percentile(sorted, 0.5))
+               .num("checksum", parts.px[parts.lane(first + live - 1)]).num("count", parts.count());
+        report("particles", "update", up, 10, ns, metrics);
+    }
+}
+
+// Mat4: the vectorized product against the scalar reference, and per-cube
+// MVP from the batched affine path against the original route (identity,
+// translate and scale as full products, then vp * model). MVP ops are
+// per cube.
+static void benchMat4(int cubes, int samples) {
+    Mat4 proj, view, vp;
+    Mat4::perspective(proj, 1.0f, 16.0f / 9.0f, 1.0f, 100.0f);
+    Mat4::lookAt(view, Vec3(3, 25, 18), Vec3(3, 0, 0), Vec3(0, 1, 0));
+
+    JsonFields none;
+    std::vector<double> ns = sample(samples, 1000, [&](int) { Mat4::multiplyScalar(vp, proj, view); view.m[12] += 1e-6f; });
+    report("mat4", "multiply_scalar", none, 1000, ns, JsonFields().num("checksum", vp.m[12]));
+    ns = sample(samples, 1000, [&](int) { Mat4::multiply(vp, proj, view); view.m[12] += 1e-6f; });
+    report("mat4", "multiply_simd", none, 1000, ns, JsonFields().num("checksum", vp.m[12]));
+
+    Random rng(11);
+    std::vector<Vec3> pos(cubes), scale(cubes);
+    for(int i=0; i<cubes; i++) {
+        pos[i] = Vec3(rng.unit() * 200 - 100, 0, rng.unit() * 200 - 100);
+        scale[i] = Vec3(0.5f + rng.unit(), 0.5f + rng.unit(), 0.5f + rng.unit());
+    }
+    std::vector<Mat4> ref(cubes), out(cubes);
+
+    ns = sample(samples, 1, [&](int) {
+        for(int i=0; i<cubes; i++) {
+            Mat4 model, t, sc, tmp;
+            t.m[12] = pos[i].x; t.m[13] = pos[i].y; t.m[14] = pos[i].z;
+            Mat4::multiplyScalar(tmp, model, t);
+            sc.m[0] = scale[i].x; sc.m[5] = scale[i].y; sc.m[10] = scale[i].z;
+            Mat4::multiplyScalar(model, tmp, sc);
+            Mat4::multiplyScalar(ref[i], vp, model);
+        }
+    });
+    scaleSamples(ns, cubes);
+    JsonFields params;
+    params.num("cubes", cubes);
+    report("mat4", "mvp_scalar", params, cubes, ns, none);
+
+    ns = sample(samples, 1, [&](int) { Mat4::batchMVP(out.data(), vp, pos.data(), scale.data(), cubes); });
+    scaleSamples(ns, cubes);
+    float maxErr = 0.0f;
+    for(int i=0; i<cubes; i++)
+        for(int k=0; k<16; k++) maxErr = fmaxf(maxErr, fabsf(ref[i].m[k] - out[i].m[k]));
+    report("mat4", "mvp_batch", params, cubes, ns, JsonFields().num("max_err", maxErr));
+}
+
+// Flow field: full chase rebuild (and chase + flee) for a goal in every
+// open cell, and the per-bot O(1) direction lookup.
+static void benchFlowField(int samples) {
+    Random rng(3);
+    Map map;
+    map.generateDerb(rng);
+    FlowField nav;
+
+    std::vector<int> goals;
+    for(int c=0; c<FlowField::N * FlowField::N; c++) if(!map.isWall(c / FlowField::N, c % FlowField::N)) goals.push_back(c);
+    const int n = (int)goals.size();
+
+    JsonFields params;
+    params.num("goals", n);
+    std::vector<double> ns = sample(samples, 4, [&](int k) { nav.rebuild(map, goals[k % n]); });
+    report("flowfield", "chase_rebuild", params, 4, ns, JsonFields());
+    ns = sample(samples, 4, [&](int k) { nav.rebuild(map, goals[k % n]); nav.ensureFlee(); });
+    report("flowfield", "chase_flee_rebuild", params, 4, ns, JsonFields());
+
+    std::vector<Vec3> probes(1024);
+    for(auto& p : probes) p = Vec3(rng.unit() * 180 - 90, 0, rng.unit() * 180 - 90);
+    float sum = 0.0f;
+    ns = sample(samples, 4096, [&](int k) { sum += nav.chaseDir(probes[k & 1023]).x; });
+    report("flowfield", "sample", JsonFields(), 4096, ns, JsonFields().num("checksum", sum));
+}
+
+// Map collision: the packed box test against the original int-grid 3x3
+// float AABB version, plus moveAndSlide. Large random steps are walked back
+// along the L-shaped path (x then z) the sweep takes; any sample inside a
+// wall counts as a tunnel and should never happen.
+static bool legacyCheckCollision(const int grid[Map::N][Map::N], Vec3 pos, float radius) {
+    float offset = Map::OFFSET;
+    int gx = (int)((pos.x + offset) / GameConfig::CELL_SIZE);
+    int gz = (int)((pos.z + offset) / GameConfig::CELL_SIZE);
+    for(int i = gx-1; i <= gx+1; i++) {
+        for(int j = gz-1; j <= gz+1; j++) {
+            if(i >= 0 && i < Map::N && j >= 0 && j < Map::N && grid[i][j] == 1) {
+                float wx = (i * GameConfig::CELL_SIZE) - offset;
+                float wz = (j * GameConfig::CELL_SIZE) - offset;
+                float halfWall = GameConfig::CELL_SIZE * 0.5f;
+                bool xOverlap = (pos.x - radius < wx + halfWall) && (pos.x + radius > wx - halfWall);
+                bool zOverlap = (pos.z - radius < wz + halfWall) && (pos.z + radius > wz - halfWall);
+                if(xOverlap && zOverlap) return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void benchMap(int samples) {
+    Random rng(5);
+    Map map;
+    map.generateDerb(rng);
+    static int grid[Map::N][Map::N];
+    for(int i=0; i<Map::N; i++) for(int j=0; j<Map::N; j++) grid[i][j] = map.isWall(i, j) ? 1 : 0;
+
+    const int n = 4096;
+    std::vector<Vec3> probes(n), steps(n);
+    for(int k=0; k<n; k++) {
+        probes[k] = Vec3(rng.unit() * 190 - 95, 0, rng.unit() * 190 - 95);
+        steps[k] = Vec3(rng.unit() * 12 - 6, 0, rng.unit() * 12 - 6);
+    }
+
+    int hits = 0, mismatches = 0;
+    std::vector<double> ns = sample(samples, n, [&](int k) { hits += legacyCheckCollision(grid, probes[k & (n-1)], 1.0f); });
+    report("map", "check_collision_legacy", JsonFields(), n, ns, JsonFields());
+    ns = sample(samples, n, [&](int k) { hits -= map.checkCollision(probes[k & (n-1)], 1.0f); });
+    for(int k=0; k<n; k++) mismatches += legacyCheckCollision(grid, probes[k], 1.0f) != map.checkCollision(probes[k], 1.0f);
+    report("map", "check_collision", JsonFields(), n, ns, JsonFields().num("mismatches", mismatches).num("checksum", hits));
+
+    float sum = 0.0f;
+    ns = sample(samples, n, [&](int k) { sum += map.moveAndSlide(probes[k & (n-1)], steps[k & (n-1)], 1.0f).x; });
+    int sweeps = 0, tunnels = 0;
+    for(int k=0; k<n; k++) {
+        Vec3 from = probes[k];
+        if(map.checkCollision(from, 1.0f)) continue;
+        Vec3 to = map.moveAndSlide(from, steps[k], 1.0f);
+        sweeps++;
+        bool bad = false;
+        for(int s=0; s<=64 && !bad; s++) {
+            float t = s / 64.0f;
+            bad = map.checkCollision(Vec3(from.x + (to.x - from.x) * t, 0, from.z), 1.0f) ||
+                  map.checkCollision(Vec3(to.x, 0, from.z + (to.z - from.z) * t), 1.0f);
+        }
+        tunnels += bad;
+    }
+    report("map", "move_and_slide", JsonFields(), n, ns,
+           JsonFields().num("sweeps", sweeps).num("tunnels", tunnels).num("checksum", sum));
+
+    Random layout(17);
+    ns = sample(samples, 1, [&](int) { map.generateDerb(layout); });
+    report("map", "generate_derb", JsonFields(), 1, ns, JsonFields().num("walls", (double)map.walls.size()));
+}
+
+// Line of sight: single DDA rays and the batched call over random segments
+// of up to 80 units. Each result is checked against a brute-force slab test
+// of the segment against every wall cell in its bounding box, as are
+// axis-aligned rays that run exactly along a cell boundary. A point on a
+// boundary belongs to the cell above it, as floorf() puts it.
+static bool bruteLineOfSight(const Map& map, Vec3 a, Vec3 b) {
+    const float cell = GameConfig::CELL_SIZE;
+    int ia = (int)floorf((a.x - Map::ORIGIN) / cell), ja = (int)floorf((a.z - Map::ORIGIN) / cell);
+    int i0 = (int)floorf((fminf(a.x, b.x) - Map::ORIGIN) / cell), i1 = (int)floorf((fmaxf(a.x, b.x) - Map::ORIGIN) / cell);
+    int j0 = (int)floorf((fminf(a.z, b.z) - Map::ORIGIN) / cell), j1 = (int)floorf((fmaxf(a.z, b.z) - Map::ORIGIN) / cell);
+    for(int i=i0; i<=i1; i++) {
+        for(int j=j0; j<=j1; j++) {
+            if((i == ia && j == ja) || !map.isWall(i, j)) continue;
+            float lo = 0.0f, hi = 1.0f;
+            float mins[2] = { Map::ORIGIN + i * cell, Map::ORIGIN + j * cell };
+            float from[2] = { a.x, a.z }, d[2] = { b.x - a.x, b.z - a.z };
+            for(int ax=0; ax<2 && lo <= hi; ax++) {
+                if(d[ax] == 0.0f) { if(from[ax] < mins[ax] || from[ax] >= mins[ax] + cell) hi = -1.0f; continue; }
+                float t0 = (mins[ax] - from[ax]) / d[ax], t1 = (mins[ax] + cell - from[ax]) / d[ax];
+                if(t0 > t1) { float s = t0; t0 = t1; t1 = s; }
+                lo = fmaxf(lo, t0); hi = fminf(hi, t1);
+            }
+            // Strict overlap: grazing a corner or edge exactly isn't a block.
+            if(lo < hi) return false;
+        }
+    }
+    return true;
+}
+
+static void benchLineOfSight(int samples) {
+    Random rng(9);
+    Map map;
+    map.generateDerb(rng);
+    const int n = 4096;
+    std::vector<Vec3> from(n), to(n);
+    for(int k=0; k<n; k++) {
+        from[k] = Vec3(rng.unit() * 190 - 95, 0, rng.unit() * 190 - 95);
+        to[k] = from[k] + Vec3(rng.unit() * 160 - 80, 0, rng.unit() * 160 - 80) * 0.5f;
+    }
+
+    int clear = 0;
+    std::vector<double> ns = sample(samples, n, [&](int k) { clear += map.lineOfSight(from[k & (n-1)], to[k & (n-1)]); });
+    int mismatches = 0, visible = 0;
+    for(int k=0; k<n; k++) {
+        bool dda = map.lineOfSight(from[k], to[k]);
+        visible += dda;
+        mismatches += dda != bruteLineOfSight(map, from[k], to[k]);
+    }
+    int boundaryMismatches = 0;
+    for(int k=0; k<1024; k++) {
+        float edge = Map::ORIGIN + (2 + rng.range(Map::N - 4)) * GameConfig::CELL_SIZE;
+        float along = rng.unit() * 190 - 95, length = rng.unit() * 80 - 40;
+        Vec3 a = (k & 1) ? Vec3(edge, 0, along) : Vec3(along, 0, edge);
+        Vec3 b = (k & 1) ? Vec3(edge, 0, along + length) : Vec3(along + length, 0, edge);
+        boundaryMismatches += map.lineOfSight(a, b) != bruteLineOfSight(map, a, b);
+    }
+    report("los", "ray", JsonFields(), n, ns,
+           JsonFields().num("visible", (double)visible / n).num("mismatches", mismatches)
+                       .num("boundary_mismatches", boundaryMismatches).num("checksum", clear));
+
+    std::vector<uint8_t> out(n);
+    ns = sample(samples, 1, [&](int) { clear -= map.lineOfSightBatch(from.data(), to.data(), n, out.data()); });
+    scaleSamples(ns, n);
+    report("los", "batch", JsonFields().num("rays", n), n, ns, JsonFields().num("checksum", clear));
+}
+
+// One full headless match tick (input, player, AI, bullets, zone) through
+// World::update with the scripted pilot. A finished match is restarted
+// with the next seed between samples.
+static void benchMatchTick(int bots, int ticks) {
+    World world(1);
+    world.botCount = bots;
+    world.reset(1);
+    const float dt = 1.0f / GameConfig::SIM_HZ;
+
+    int matches = 0;
+    std::vector<double> ns = sample(ticks, 1, [&](int) {
+        pilotInput(world);
+        world.update(dt);
+    }, [&] {
+        if(world.gameState != 0) { matches++; world.reset(world.seed + 1); }
+        world.entities->consumeKillEvent();
+        world.weapons->consumeShootEvent();
+    });
+
+    JsonFields params;
+    params.num("bots", bots);
+    report("match", "tick", params, 1, ns,
+           JsonFields().num("matches_finished", matches).num("state_hash_low", (double)(world.stateHash() & 0xFFFFFFu)));
+}
+
+// Whole match ticks in each world mode (WorldMode.h). The fixed modes
+// keep every pool inline, so heap_allocs_per_tick, counted inside the
+// timed ticks, should be 0 for them; dropped counts spawns a full fixed
+// pool refused or overwrote and should stay 0 too. Standard's pools grow
+// on demand, for comparison.
+template<class Mode>
+static void benchMode(int ticks) {
+    BasicWorld<Mode>* worldPtr = new BasicWorld<Mode>(1);
+    BasicWorld<Mode>& world = *worldPtr;
+    const float dt = 1.0f / GameConfig::SIM_HZ;
+
+    int matches = 0;
+    long long botTicks = 0, allocs = 0;
+    int peakBullets = 0, peakParticles = 0;
+    std::vector<double> ns = sample(ticks, 1, [&](int) {
+        long long before = heapAllocs.load(std::memory_order_relaxed);
+        pilotInput(world);
+        world.update(dt);
+        allocs += heapAllocs.load(std::memory_order_relaxed) - before;
+    }, [&] {
+        if(world.gameState != 0) { matches++; world.reset(world.seed + 1); }
+        botTicks += world.entities->botsAlive;
+        peakBullets = std::max(peakBullets, world.weapons->bullets.count());
+        peakParticles = std::max(peakParticles, world.entities->particles.count());
+    });
+
+    int dropped = world.entities->droppedBots + world.weapons->bullets.dropped + world.entities->particles.dropped;
+    double meanNs = 0.0;
+    for(double v : ns) meanNs += v;
+    meanNs /= ns.size();
+    JsonFields params;
+    params.str("mode", Mode::NAME).num("map_size", Mode::MAP_SIZE).num("bots", Mode::BOTS)
+          .num("bot_slots", Mode::BOT_SLOTS).num("bullet_slots", Mode::BULLET_SLOTS)
+          .num("particle_slots", Mode::PARTICLE_SLOTS);
+    report("modes", "tick", params, 1, ns,
+           JsonFields().num("ns_per_live_bot", botTicks > 0 ? meanNs * ticks / botTicks : 0.0)
+                       .num("heap_allocs_per_tick", (double)allocs / ticks)
+                       .num("peak_bullets", peakBullets).num("peak_particles", peakParticles)
+                       .num("dropped", dropped).num("matches_finished", matches));
+    delete worldPtr;
+}
+
+// Snapshot save and restore of a match 600 ticks in, against a plain
+// reset(seed) (map generation plus bot spawns) for scale. The writer and
+// the restoring world are reused, as a resume-on-launch path would.
+static void benchSnapshot(int bots, int samples) {
+    World world(1), copy(1);
+    world.botCount = bots;
+    world.reset(1);
+    const float dt = 1.0f / GameConfig::SIM_HZ;
+    for(int t=0; t<600 && world.gameState == 0; t++) {
+        pilotInput(world);
+        world.update(dt);
+    }
+
+    ByteWriter w;
+    std::vector<double> ns = sample(samples, 1, [&](int) { w.bytes.clear(); world.save(w); });
+    JsonFields params;
+    params.num("bots", bots);
+    report("snapshot", "save", params, 1, ns, JsonFields().num("bytes", (double)w.bytes.size()));
+
+    int failures = 0;
+    ns = sample(samples, 1, [&](int) {
+        ByteReader r(w.bytes.data(), w.bytes.size());
+        failures += !copy.load(r);
+    });
+    report("snapshot", "restore", params, 1, ns,
+           JsonFields().num("failures", failures).num("hash_match", copy.stateHash() == world.stateHash()));
+
+    copy.botCount = bots;
+    ns = sample(samples, 1, [&](int) { copy.reset(world.seed); });
+    report("snapshot", "reset_baseline", params, 1, ns, JsonFields());
+}
+
+// Profiler cost: one empty zone recorded, then whole frames with recording
+// off, on for every frame, and on for one frame in `interval`. A frame is
+// GameEngine::step into a RecordingDevice (the tick plus the render pass,
+// without driver or GPU time) or, for "tick", a bare World::update. The
+// variants play the same seed in lockstep, interleaved in blocks, so a
+// block does the same work in each; overhead_pct is the median over blocks
+// of a variant's time against the off run's, which cancels the match's own
+// spikes and most of the host's (an off-vs-off run stays within about 2.5%
+// at 30 bots). zone_pct predicts the cost from zones per recorded frame
+// times the empty zone, over the median off frame, and resolves what
+// overhead_pct can't.
+template<class Step, class Prepare>
+static void profilerOverhead(const char* unit, int bots, int frames, int interval, double zoneNs,
+                             Step step, Prepare prepare) {
+    Profiler& prof = Profiler::get();
+    const int block = 50, intervals[3] = { 0, 1, interval };
+    std::vector<double> frameNs[3], ratios[3];
+    long long zones = 0, zoneFrames = 0;
+    for(int done=0; done<frames; done+=block) {
+        double sums[3] = { 0, 0, 0 };
+        for(int v=0; v<3; v++) {
+            prof.setEnabled(intervals[v] > 0);
+            prof.setSampleInterval(intervals[v] > 0 ? intervals[v] : 1);
+            prof.reset();
+            std::vector<double> part = sample(block, 1, [&](int) { step(v); }, [&] { prepare(v); });
+            for(double t : part) sums[v] += t;
+            frameNs[v].insert(frameNs[v].end(), part.begin(), part.end());
+            if(v == 1) { zones += (long long)prof.collect().size(); zoneFrames += block; }
+        }
+        for(int v=1; v<3; v++) ratios[v].push_back(sums[v] / sums[0]);
+    }
+    prof.setEnabled(false);
+    prof.setSampleInterval(1);
+    prof.reset();
+
+    std::vector<double> off = frameNs[0];
+    std::sort(off.begin(), off.end());
+    double offP50 = percentile(off, 0.5);
+    double zonesPerFrame = (double)zones / zoneFrames;
+    for(int v=0; v<3; v++) {
+        JsonFields metrics;
+        if(v > 0) {
+            std::sort(ratios[v].begin(), ratios[v].end());
+            metrics.num("overhead_pct", (ratios[v][ratios[v].size() / 2] - 1.0) * 100.0)
+                   .num("zones_per_frame", zonesPerFrame)
+                   .num("zone_pct", zonesPerFrame * zoneNs / intervals[v] / offP50 * 100.0);
+        }
+        JsonFields params;
+        params.num("bots", bots);
+        if(v > 0) params.num("sample_interval", intervals[v]);
+        std::string name = std::string(unit) + (v == 0 ? "_off" : "_on");
+        report("profiler", name.c_str(), params, 1, frameNs[v], metrics);
+    }
+}
+
+static void benchProfiler(int bots, int frames, int interval) {
+    if(!PROFILER_ENABLED) return;
+    Profiler& prof = Profiler::get();
+    prof.setEnabled(true);
+    std::vector<double> ns = sample(200, 4096, [&](int) { PROFILE_ZONE(PZ_ZONE); });
+    report("profiler", "empty_zone", JsonFields(), 4096, ns, JsonFields());
+    std::vector<double> sorted = ns;
+    std::sort(sorted.begin(), sorted.end());
+    double zoneNs = percentile(sorted, 0.5);
+    prof.setEnabled(false);
+    prof.reset();
+
+    const float dt = 1.0f / GameConfig::SIM_HZ;
+    RecordingDevice devices[3] = { RecordingDevice(false), RecordingDevice(false), RecordingDevice(false) };
+    GameEngine* engines[3];
+    for(int v=0; v<3; v++) {
+        engines[v] = new GameEngine(&devices[v], 1);
+        engines[v]->init();
+        engines[v]->resize(1280, 720);
+        engines[v]->getWorld()->botCount = bots;
+        engines[v]->reset(1);
+    }
+    profilerOverhead("frame", bots, frames, interval, zoneNs, [&](int v) {
+        World& w = *engines[v]->getWorld();
+        PilotInput in = pilot(w);
+        engines[v]->input(in.x, in.z, in.fire, in.dash, in.ult);
+        engines[v]->step(dt);
+    }, [&](int v) {
+        World& w = *engines[v]->getWorld();
+        if(w.gameState != 0) engines[v]->reset(w.seed + 1);
+    });
+    for(int v=0; v<3; v++) delete engines[v];
+
+    World* worlds[3];
+    for(int v=0; v<3; v++) { worlds[v] = new World(1); worlds[v]->botCount = bots; worlds[v]->reset(1); }
+    profilerOverhead("tick", bots, frames, interval, zoneNs, [&](int v) {
+        prof.beginFrame();
+        pilotInput(*worlds[v]);
+        worlds[v]->update(dt);
+    }, [&](int v) {
+        if(worlds[v]->gameState != 0) worlds[v]->reset(worlds[v]->seed + 1);
+    });
+    for(int v=0; v<3; v++) delete worlds[v];
+}
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    reportMeta();
+
+    if(strstr("bot_ai", filter)) {
+        const int counts[] = { 30, 300, 3000 };
+        for(int n : counts) benchBotAI(n, n >= 3000 ? 100 : 1000, 1, true);
+        for(int n : counts) benchBotAI(n, n >= 3000 ? 100 : 1000, 1, false);
+        int hw = (int)std::thread::hardware_concurrency();
+        if(hw > 1) benchBotAI(3000, 100, hw, true);
+    }
+
+    if(strstr("bullets", filter)) {
+        benchBullets(30, 1024, 400);
+        benchBullets(300, 4096, 200);
+    }
+
+    if(strstr("map", filter)) {
+        benchMap(200);
+    }
+
+    if(strstr("los", filter)) {
+        benchLineOfSight(200);
+    }
+
+    if(strstr("mat4", filter)) {
+        benchMat4(200, 500);
+    }
+
+    if(strstr("integrate", filter)) {
+        benchIntegrate(100, 200, 500);
+        benchIntegrate(10000, 200, 10);
+    }
+
+    if(strstr("particles", filter)) {
+        benchParticleSpawn(20, 200);
+        benchParticleUpdate(4096, 200);
+        benchParticleUpdate(65536, 100);
+    }
+
+    if(strstr("flowfield", filter)) {
+        benchFlowField(200);
+    }
+
+    if(strstr("match", filter)) {
+        benchMatchTick(GameConfig::BOT_COUNT, 5000);
+        benchMatchTick(300, 1000);
+    }
+
+    if(strstr("modes", filter)) {
+        benchMode<MobileMode>(5000);
+        benchMode<StandardMode>(5000);
+        benchMode<HordeMode>(1000);
+    }
+
+    if(strstr("snapshot", filter)) {
+        benchSnapshot(GameConfig::BOT_COUNT, 500);
+        benchSnapshot(300, 200);
+    }
+
+    if(strstr("profiler", filter)) {
+        benchProfiler(GameConfig::BOT_COUNT, 20000, Profiler::APP_SAMPLE_INTERVAL);
+        benchProfiler(300, 4000, Profiler::APP_SAMPLE_INTERVAL);
+    }
+    return 0;
+}
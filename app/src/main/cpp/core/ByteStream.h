@@ -0,0 +1,112 @@
+#ifndef BYTE_STREAM_H
+#define BYTE_STREAM_H
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Little-endian binary encoding for recordings and snapshots. Varints are
+// LEB128 (7 bits per byte, low first); signed values are zigzag-mapped
+// first so small deltas of either sign stay one byte. pod() copies a
+// trivially copyable value (float, Vec3) as host bytes; every target we
+// ship is little-endian.
+class ByteWriter {
+public:
+    std::vector<uint8_t> bytes;
+
+    void u8(uint8_t v) { bytes.push_back(v); }
+
+    void u32(uint32_t v) { for(int k=0; k<4; k++) bytes.push_back((uint8_t)(v >> (8 * k))); }
+
+    void u64(uint64_t v) { for(int k=0; k<8; k++) bytes.push_back((uint8_t)(v >> (8 * k))); }
+
+    void varint(uint64_t v) {
+        while(v >= 0x80) { bytes.push_back((uint8_t)(v | 0x80)); v >>= 7; }
+        bytes.push_back((uint8_t)v);
+    }
+
+    void svarint(int64_t v) { varint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63)); }
+
+    void raw(const void* p, size_t n) {
+        const uint8_t* b = (const uint8_t*)p;
+        bytes.insert(bytes.end(), b, b + n);
+    }
+
+    template<class T> void pod(const T& v) { raw(&v, sizeof(T)); }
+
+    bool save(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if(!f) return false;
+        bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+        return fclose(f) == 0 && ok;
+    }
+};
+
+// Reads what ByteWriter wrote. Running past the end sets `ok` to false and
+// yields zeros, so callers check once after a batch of reads.
+class ByteReader {
+public:
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok;
+
+    ByteReader(const uint8_t* data, size_t n) : p(data), end(data + n), ok(true) {}
+
+    size_t remaining() const { return (size_t)(end - p); }
+
+    uint8_t u8() {
+        if(p >= end) { ok = false; return 0; }
+        return *p++;
+    }
+
+    uint32_t u32() {
+        uint32_t v = 0;
+        for(int k=0; k<4; k++) v |= (uint32_t)u8() << (8 * k);
+        return v;
+    }
+
+    uint64_t u64() {
+        uint64_t v = 0;
+        for(int k=0; k<8; k++) v |= (uint64_t)u8() << (8 * k);
+        return v;
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for(int shift=0; shift<64; shift+=7) {
+            uint8_t b = u8();
+            v |= (uint64_t)(b & 0x7F) << shift;
+            if(!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t svarint() {
+        uint64_t v = varint();
+        return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+
+    bool raw(void* out, size_t n) {
+        if(remaining() < n) { ok = false; p = end; memset(out, 0, n); return false; }
+        memcpy(out, p, n);
+        p += n;
+        return true;
+    }
+
+    template<class T> void pod(T& v) { raw(&v, sizeof(T)); }
+};
+
+// Whole file into `out`. False if it can't be opened or read.
+static inline bool readFile(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if(!f) return false;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    out.resize(n > 0 ? (size_t)n : 0);
+    bool ok = n >= 0 && fread(out.data(), 1, out.size(), f) == out.size();
+    fclose(f);
+    return ok;
+}
+#endif
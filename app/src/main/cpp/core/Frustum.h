@@ -0,0 +1,58 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+#include "MathUtils.h"
+
+// Six clip planes pulled out of a view-projection matrix (Gribb/Hartmann).
+// Planes point inward and are normalized, so plane distance is in world
+// units and sphere tests compare directly against the radius.
+struct Frustum {
+    float planes[6][4]; // a, b, c, d with a*x + b*y + c*z + d >= 0 inside
+
+    void extract(const Mat4& vp) {
+        const float* m = vp.m; // column-major: row r is m[r], m[4+r], m[8+r], m[12+r]
+        for(int p=0; p<6; p++) {
+            int row = p / 2;
+            float sign = (p % 2 == 0) ? 1.0f : -1.0f; // left/bottom/near add, right/top/far subtract
+            float a = m[3]  + sign * m[row];
+            float b = m[7]  + sign * m[4 + row];
+            float c = m[11] + sign * m[8 + row];
+            float d = m[15] + sign * m[12 + row];
+            float len = sqrtf(a*a + b*b + c*c);
+            float inv = len > 0.0f ? 1.0f / len : 0.0f;
+            planes[p][0] = a * inv; planes[p][1] = b * inv; planes[p][2] = c * inv; planes[p][3] = d * inv;
+        }
+    }
+
+    bool sphereVisible(float x, float y, float z, float radius) const {
+        for(int p=0; p<6; p++) {
+            if(planes[p][0]*x + planes[p][1]*y + planes[p][2]*z + planes[p][3] < -radius) return false;
+        }
+        return true;
+    }
+
+    // Visible unless the box is entirely behind one plane (tests the corner
+    // furthest along each plane normal).
+    bool aabbVisible(Vec3 mn, Vec3 mx) const {
+        for(int p=0; p<6; p++) {
+            float x = planes[p][0] >= 0.0f ? mx.x : mn.x;
+            float y = planes[p][1] >= 0.0f ? mx.y : mn.y;
+            float z = planes[p][2] >= 0.0f ? mx.z : mn.z;
+            if(planes[p][0]*x + planes[p][1]*y + planes[p][2]*z + planes[p][3] < 0.0f) return false;
+        }
+        return true;
+    }
+
+    // Batched sphere test over a structure-of-arrays set addressed through
+    // `indices`. Writes the visible indices to `out` (may alias `indices`)
+    // and returns how many there are.
+    int cullSpheres(const float* px, const float* py, const float* pz, const int* indices, int count,
+                    float radius, int* out) const {
+        int n = 0;
+        for(int k=0; k<count; k++) {
+            int i = indices[k];
+            if(sphereVisible(px[i], py[i], pz[i], radius)) out[n++] = i;
+        }
+        return n;
+    }
+};
+#endif
@@ -0,0 +1,57 @@
+#ifndef INLINE_VECTOR_H
+#define INLINE_VECTOR_H
+#include <stddef.h>
+#include <array>
+#include <type_traits>
+#include <vector>
+
+// The part of std::vector the entity pools use, over a std::array of
+// exactly N elements held inline. It never allocates: resize() and
+// push_back() past N are the caller's bug, so pools check against
+// capacity() before they get there. Elements beyond size() start
+// value-initialised and then keep whatever they last held.
+template<class T, int N>
+class InlineVector {
+public:
+    InlineVector() : items(), n(0) {}
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+
+    T* data() { return items.data(); }
+    const T* data() const { return items.data(); }
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    T* begin() { return items.data(); }
+    T* end() { return items.data() + n; }
+    const T* begin() const { return items.data(); }
+    const T* end() const { return items.data() + n; }
+    T& back() { return items[n - 1]; }
+    const T& back() const { return items[n - 1]; }
+
+    void push_back(const T& v) { items[n++] = v; }
+    void pop_back() { n--; }
+    void clear() { n = 0; }
+
+    // Like std::vector's: elements past the old size become v.
+    void resize(size_t count, const T& v = T()) {
+        for(size_t i=n; i<count; i++) items[i] = v;
+        n = count;
+    }
+
+    void assign(size_t count, const T& v) {
+        for(size_t i=0; i<count; i++) items[i] = v;
+        n = count;
+    }
+
+private:
+    std::array<T, N> items;
+    size_t n;
+};
+
+// Per-slot storage for a pool of CAPACITY slots: a growable std::vector
+// when CAPACITY is 0, otherwise inline.
+template<class T, int CAPACITY>
+using PoolVector = typename std::conditional<CAPACITY == 0, std::vector<T>, InlineVector<T, CAPACITY>>::type;
+#endif
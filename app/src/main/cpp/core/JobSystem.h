@@ -0,0 +1,118 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing pool for data-parallel loops. parallelFor() cuts an
+// index range into chunks and deals them round-robin into one deque per
+// worker; each worker pops its own deque from the back and, when empty,
+// steals from the front of the others. The calling thread works as
+// worker 0 and returns once every chunk has run, so callers see a plain
+// blocking loop. Chunks must only write state owned by their indices.
+class JobSystem {
+public:
+    // `threads` counts the caller; 1 runs everything inline.
+    explicit JobSystem(int threads = 1)
+        : queues(threads < 1 ? 1 : threads), stopping(false), generation(0), pending(0), job(NULL) {
+        for(int i=1; i<(int)queues.size(); i++) workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(auto& t : workers) t.join();
+    }
+
+    int threadCount() const { return (int)queues.size(); }
+
+    // Runs fn(begin, end) over [0, count) in chunks of at most `grain`.
+    // Ranges at or below one chunk, or a single-thread pool, run inline.
+    void parallelFor(int count, int grain, const std::function<void(int, int)>& fn) {
+        if(count <= 0) return;
+        if(grain < 1) grain = 1;
+        if(count <= grain || queues.size() == 1) { fn(0, count); return; }
+
+        // Publish the job before any chunk becomes visible: a worker still
+        // draining the previous batch may pop a chunk the moment it lands.
+        int chunks = (count + grain - 1) / grain;
+        job = &fn;
+        pending.store(chunks);
+        for(int c=0; c<chunks; c++) {
+            Queue& q = queues[c % queues.size()];
+            std::lock_guard<std::mutex> lock(q.m);
+            q.items.push_back(Range{c * grain, c * grain + grain < count ? c * grain + grain : count});
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            generation++;
+        }
+        wake.notify_all();
+
+        while(pending.load() > 0) {
+            if(!runOne(0)) std::this_thread::yield();
+        }
+        job = NULL;
+    }
+
+private:
+    struct Range { int begin, end; };
+    struct Queue {
+        std::mutex m;
+        std::deque<Range> items;
+    };
+
+    std::vector<Queue> queues;
+    std::vector<std::thread> workers;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping;
+    unsigned generation;
+    std::atomic<int> pending;
+    const std::function<void(int, int)>* job;
+
+    bool pop(int self, Range& r) {
+        Queue& own = queues[self];
+        {
+            std::lock_guard<std::mutex> lock(own.m);
+            if(!own.items.empty()) { r = own.items.back(); own.items.pop_back(); return true; }
+        }
+        for(size_t k=1; k<queues.size(); k++) {
+            Queue& victim = queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.m);
+            if(!victim.items.empty()) { r = victim.items.front(); victim.items.pop_front(); return true; }
+        }
+        return false;
+    }
+
+    bool runOne(int self) {
+        Range r;
+        if(!pop(self, r)) return false;
+        (*job)(r.begin, r.end);
+        pending.fetch_sub(1);
+        return true;
+    }
+
+    void workerLoop(int self) {
+        unsigned seen = 0;
+        for(;;) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait(lock, [&]{ return stopping || generation != seen; });
+                if(stopping) return;
+                seen = generation;
+            }
+            while(pending.load() > 0) {
+                if(!runOne(self)) std::this_thread::yield();
+            }
+        }
+    }
+};
+#endif
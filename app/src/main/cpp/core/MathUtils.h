@@ -3,6 +3,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include "SimdKernels.h"
 
 #define PI 3.14159265f
 
@@ -42,8 +43,9 @@ inline bool checkCircleCollision(Vec3 p1, float r1, Vec3 p2, float r2) {
     return distSq < (radSum * radSum);
 }
 
-// Column-Major Order 4x4 Matrix
-struct Mat4 {
+// Column-Major Order 4x4 Matrix. Storage is 16-byte aligned so each column
+// is one aligned vector load.
+struct alignas(16) Mat4 {
     float m[16];
 
     Mat4() { 
@@ -55,7 +57,8 @@ struct Mat4 {
         m[0] = 1.0f; m[5] = 1.0f; m[10] = 1.0f; m[15] = 1.0f;
     }
 
-    static void multiply(Mat4& out, const Mat4& a, const Mat4& b) {
+    // Reference 4x4 product; out may alias a or b.
+    static void multiplyScalar(Mat4& out, const Mat4& a, const Mat4& b) {
         float temp[16];
         for (int c = 0; c < 4; c++) {
             for (int r = 0; r < 4; r++) {
@@ -69,6 +72,79 @@ struct Mat4 {
         memcpy(out.m, temp, 16 * sizeof(float));
     }
 
+    // Column c of a*b is a's columns weighted by b's column c. All of a and b
+    // is loaded before anything is stored, so out may alias either.
+    static void multiply(Mat4& out, const Mat4& a, const Mat4& b) {
+#if defined(SIMD_SSE2)
+        __m128 a0 = _mm_load_ps(a.m), a1 = _mm_load_ps(a.m + 4), a2 = _mm_load_ps(a.m + 8), a3 = _mm_load_ps(a.m + 12);
+        __m128 col[4];
+        for (int c = 0; c < 4; c++) {
+            const float* bc = b.m + c * 4;
+            col[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(bc[0])), _mm_mul_ps(a1, _mm_set1_ps(bc[1]))),
+                                _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(bc[2])), _mm_mul_ps(a3, _mm_set1_ps(bc[3]))));
+        }
+        for (int c = 0; c < 4; c++) _mm_store_ps(out.m + c * 4, col[c]);
+#elif defined(SIMD_NEON)
+        float32x4_t a0 = vld1q_f32(a.m), a1 = vld1q_f32(a.m + 4), a2 = vld1q_f32(a.m + 8), a3 = vld1q_f32(a.m + 12);
+        float32x4_t col[4];
+        for (int c = 0; c < 4; c++) {
+            float32x4_t bc = vld1q_f32(b.m + c * 4);
+            float32x4_t v = vmulq_lane_f32(a0, vget_low_f32(bc), 0);
+            v = vmlaq_lane_f32(v, a1, vget_low_f32(bc), 1);
+            v = vmlaq_lane_f32(v, a2, vget_high_f32(bc), 0);
+            col[c] = vmlaq_lane_f32(v, a3, vget_high_f32(bc), 1);
+        }
+        for (int c = 0; c < 4; c++) vst1q_f32(out.m + c * 4, col[c]);
+#else
+        multiplyScalar(out, a, b);
+#endif
+    }
+
+    // Column-major translate * scale with no rotation, written straight into
+    // 16 floats (a Mat4 or an instance buffer slot).
+    static void writeTRS(float* out, Vec3 pos, Vec3 s) {
+        out[0] = s.x;   out[1] = 0.0f;  out[2] = 0.0f;   out[3] = 0.0f;
+        out[4] = 0.0f;  out[5] = s.y;   out[6] = 0.0f;   out[7] = 0.0f;
+        out[8] = 0.0f;  out[9] = 0.0f;  out[10] = s.z;   out[11] = 0.0f;
+        out[12] = pos.x; out[13] = pos.y; out[14] = pos.z; out[15] = 1.0f;
+    }
+
+    // out[i] = vp * translate(pos[i]) * scale(scale[i]) for n cubes. With
+    // T*S affine and axis-aligned, each result is three scaled vp columns
+    // plus one weighted sum: 24 multiplies instead of two full products.
+    static void batchMVP(Mat4* out, const Mat4& vp, const Vec3* pos, const Vec3* scale, int n) {
+#if defined(SIMD_SSE2)
+        __m128 c0 = _mm_load_ps(vp.m), c1 = _mm_load_ps(vp.m + 4), c2 = _mm_load_ps(vp.m + 8), c3 = _mm_load_ps(vp.m + 12);
+        for (int i = 0; i < n; i++) {
+            float* o = out[i].m;
+            _mm_store_ps(o,      _mm_mul_ps(c0, _mm_set1_ps(scale[i].x)));
+            _mm_store_ps(o + 4,  _mm_mul_ps(c1, _mm_set1_ps(scale[i].y)));
+            _mm_store_ps(o + 8,  _mm_mul_ps(c2, _mm_set1_ps(scale[i].z)));
+            _mm_store_ps(o + 12, _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(pos[i].x)), _mm_mul_ps(c1, _mm_set1_ps(pos[i].y))),
+                                            _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(pos[i].z)), c3)));
+        }
+#elif defined(SIMD_NEON)
+        float32x4_t c0 = vld1q_f32(vp.m), c1 = vld1q_f32(vp.m + 4), c2 = vld1q_f32(vp.m + 8), c3 = vld1q_f32(vp.m + 12);
+        for (int i = 0; i < n; i++) {
+            float* o = out[i].m;
+            vst1q_f32(o,      vmulq_n_f32(c0, scale[i].x));
+            vst1q_f32(o + 4,  vmulq_n_f32(c1, scale[i].y));
+            vst1q_f32(o + 8,  vmulq_n_f32(c2, scale[i].z));
+            vst1q_f32(o + 12, vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(c3, c0, pos[i].x), c1, pos[i].y), c2, pos[i].z));
+        }
+#else
+        for (int i = 0; i < n; i++) {
+            float* o = out[i].m;
+            for (int r = 0; r < 4; r++) {
+                o[r]      = vp.m[r] * scale[i].x;
+                o[4 + r]  = vp.m[4 + r] * scale[i].y;
+                o[8 + r]  = vp.m[8 + r] * scale[i].z;
+                o[12 + r] = vp.m[r] * pos[i].x + vp.m[4 + r] * pos[i].y + vp.m[8 + r] * pos[i].z + vp.m[12 + r];
+            }
+        }
+#endif
+    }
+
     static void perspective(Mat4& out, float fov, float aspect, float n, float f) {
         float t = tan(fov * 0.5f);
         float a = 1.0f / t;
@@ -99,26 +175,16 @@ struct Mat4 {
         out.m[3]=0.0f; out.m[7]=0.0f; out.m[11]=0.0f; out.m[15]=1.0f;
     }
 
-    // Correct Translation Logic
+    // inOut = inOut * translate(x, y, z): only the last column changes.
     static void translate(Mat4& inOut, float x, float y, float z) {
-        Mat4 t; // Identity
-        t.m[12] = x;
-        t.m[13] = y;
-        t.m[14] = z;
-        Mat4 result;
-        multiply(result, inOut, t); // Apply translation
-        memcpy(inOut.m, result.m, 16 * sizeof(float));
+        float* m = inOut.m;
+        for (int r = 0; r < 4; r++) m[12 + r] += m[r] * x + m[4 + r] * y + m[8 + r] * z;
     }
 
-    // Correct Non-Uniform Scaling Logic
+    // inOut = inOut * scale(x, y, z): scales the first three columns.
     static void scale(Mat4& inOut, float x, float y, float z) {
-        Mat4 s; // Identity
-        s.m[0] = x;
-        s.m[5] = y;
-        s.m[10] = z;
-        Mat4 result;
-        multiply(result, inOut, s); // Apply scaling
-        memcpy(inOut.m, result.m, 16 * sizeof(float));
+        float* m = inOut.m;
+        for (int r = 0; r < 4; r++) { m[r] *= x; m[4 + r] *= y; m[8 + r] *= z; }
     }
 };
 #endif
@@ -0,0 +1,273 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Scoped frame profiler. PROFILE_ZONE(PZ_AI) times the rest of the
+// enclosing block and appends one event to the calling thread's ring
+// buffer: a fixed array only that thread writes, published with a single
+// release store of the head, so recording takes no lock. The thread finds
+// its ring through one thread_local pointer, set on its first zone; the
+// enabled flag is a plain static, so a zone never goes through get().
+// Readers copy whatever the rings hold (the last RING_EVENTS zones per
+// thread, less a guard band) and drop anything the owner may have
+// overwritten while they copied.
+//
+// Zones are stamped with the CPU's cycle counter (rdtsc, or the ARM
+// virtual counter), about half the cost of steady_clock, and converted
+// to ns when read, using steady_clock over the whole run as the reference.
+// Those two reads are nearly all a recorded zone costs.
+//
+// Build with PROFILER_ENABLED=0 and every zone compiles to nothing. When
+// compiled in, recording still waits for setEnabled(true), and with a
+// sample interval of n only every nth beginFrame() period is recorded.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 0
+#endif
+
+enum ProfileZone {
+    PZ_FRAME, PZ_TICK, PZ_ZONE, PZ_PLAYER, PZ_WEAPONS, PZ_AI, PZ_AI_JOB, PZ_NAV,
+    PZ_COLLISION, PZ_PARTICLES, PZ_WALL_DRAW, PZ_ENTITY_DRAW, PZ_COUNT
+};
+
+static const char* const PROFILE_ZONE_NAMES[PZ_COUNT] = {
+    "frame", "tick", "zone", "player", "weapons", "ai", "ai_job", "nav",
+    "collision", "particles", "wall_draw", "entity_draw"
+};
+
+// One recorded zone, in raw counter ticks. Plain fields: the owner writes
+// them before the release store of its ring's head that publishes them.
+struct ProfileSlot {
+    uint64_t start;
+    uint32_t ticks; // duration, saturated
+    uint32_t zone;
+};
+
+struct ProfileRing {
+    static constexpr int EVENTS = 16384; // power of two
+    std::atomic<uint32_t> head;          // events ever written; owner thread only
+    ProfileSlot slots[EVENTS];
+    ProfileRing() : head(0) {}
+};
+
+// The calling thread's ring, or NULL until its first recorded zone.
+inline thread_local ProfileRing* profileThreadRing = NULL;
+
+// Rolling timing of one zone over the events currently held in the rings.
+struct ZoneSummary {
+    int count;
+    double p50Us, p99Us, maxUs, totalMs;
+};
+
+class Profiler {
+public:
+    static constexpr int RING_EVENTS = ProfileRing::EVENTS; // per thread
+    // Slots this close to being overwritten are never trusted by a reader:
+    // the owner's plain stores into the next slots are not ordered after
+    // the head it last published.
+    static constexpr int GUARD_EVENTS = 256;
+    // The app records one frame in this many; see "benchmarks profiler".
+    static constexpr int APP_SAMPLE_INTERVAL = 32;
+
+    static Profiler& get() {
+        static Profiler instance;
+        return instance;
+    }
+
+    static bool enabled() { return recording.load(std::memory_order_relaxed); }
+
+    void setEnabled(bool v) {
+        on.store(v, std::memory_order_relaxed);
+        recording.store(v, std::memory_order_relaxed);
+    }
+
+    void setSampleInterval(int frames) { sampleInterval = frames < 1 ? 1 : frames; }
+
+    // Marks a frame boundary; decides whether the coming frame records.
+    // Called from the thread that drives frames.
+    void beginFrame() {
+        frame++;
+        recording.store(on.load(std::memory_order_relaxed) && frame % sampleInterval == 0, std::memory_order_relaxed);
+    }
+
+    // Raw timestamp in counter ticks.
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t v;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // ns per counter tick, measured against steady_clock since creation.
+    double nsPerTick() const {
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - epoch).count();
+        uint64_t ticks = now() - epochTicks;
+        return ticks > 0 ? ns / ticks : 1.0;
+    }
+
+    static void record(ProfileZone zone, uint64_t start, uint64_t end) {
+        ProfileRing* r = profileThreadRing;
+        if(!r) r = get().registerThread();
+        uint32_t h = r->head.load(std::memory_order_relaxed);
+        ProfileSlot& s = r->slots[h & (RING_EVENTS - 1)];
+        uint64_t dur = end > start ? end - start : 0;
+        s.start = start;
+        s.ticks = dur < 0xFFFFFFFFull ? (uint32_t)dur : 0xFFFFFFFFu;
+        s.zone = zone;
+        r->head.store(h + 1, std::memory_order_release);
+    }
+
+    struct Event {
+        uint64_t start;    // ns since the profiler was created
+        uint32_t duration; // ns
+        uint16_t zone;
+        uint16_t thread;
+    };
+
+    // Consistent copy of every ring, oldest first per thread.
+    std::vector<Event> collect() {
+        std::vector<Event> out;
+        double scale = nsPerTick();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for(size_t t=0; t<rings.size(); t++) {
+            ProfileRing* r = rings[t];
+            uint32_t end = r->head.load(std::memory_order_acquire);
+            const uint32_t keep = RING_EVENTS - GUARD_EVENTS;
+            uint32_t begin = end > keep ? end - keep : 0;
+            size_t first = out.size();
+            for(uint32_t k=begin; k<end; k++) {
+                const ProfileSlot& s = r->slots[k & (RING_EVENTS - 1)];
+                double dur = s.ticks * scale;
+                Event e = { (uint64_t)((s.start - epochTicks) * scale),
+                            dur < 4294967295.0 ? (uint32_t)dur : 0xFFFFFFFFu, (uint16_t)s.zone, (uint16_t)t };
+                out.push_back(e);
+            }
+            // Slots the owner reused while we copied are torn; drop them, and
+            // the guard band before them. Slot k may be mid-rewrite as soon
+            // as head reaches k + RING_EVENTS.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t after = r->head.load(std::memory_order_relaxed);
+            uint32_t stale = after >= keep ? after - keep : 0;
+            if(stale > begin) {
+                size_t drop = std::min<size_t>(stale - begin, out.size() - first);
+                out.erase(out.begin() + first, out.begin() + first + drop);
+            }
+        }
+        return out;
+    }
+
+    // Clears every ring. Only safe while no thread is recording.
+    void reset() {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for(ProfileRing* r : rings) r->head.store(0, std::memory_order_relaxed);
+    }
+
+    void summarize(ZoneSummary out[PZ_COUNT]) {
+        std::vector<Event> events = collect();
+        std::vector<uint32_t> durations;
+        for(int z=0; z<PZ_COUNT; z++) {
+            durations.clear();
+            for(const Event& e : events) if(e.zone == z) durations.push_back(e.duration);
+            ZoneSummary& s = out[z];
+            s.count = (int)durations.size();
+            s.p50Us = s.p99Us = s.maxUs = s.totalMs = 0.0;
+            if(durations.empty()) continue;
+            std::sort(durations.begin(), durations.end());
+            double total = 0.0;
+            for(uint32_t d : durations) total += d;
+            s.p50Us = durations[(durations.size() - 1) / 2] / 1e3;
+            s.p99Us = durations[(durations.size() * 99 - 1) / 100] / 1e3;
+            s.maxUs = durations.back() / 1e3;
+            s.totalMs = total / 1e6;
+        }
+    }
+
+    // {"zone":{"count":..,"p50_us":..,"p99_us":..,"max_us":..,"total_ms":..},...}
+    // for every zone with at least one event.
+    std::string summaryJson() {
+        ZoneSummary zs[PZ_COUNT];
+        summarize(zs);
+        std::string json = "{";
+        char buf[192];
+        for(int z=0; z<PZ_COUNT; z++) {
+            if(zs[z].count == 0) continue;
+            snprintf(buf, sizeof(buf), "%s\"%s\":{\"count\":%d,\"p50_us\":%.2f,\"p99_us\":%.2f,\"max_us\":%.2f,\"total_ms\":%.3f}",
+                     json.size() > 1 ? "," : "", PROFILE_ZONE_NAMES[z], zs[z].count,
+                     zs[z].p50Us, zs[z].p99Us, zs[z].maxUs, zs[z].totalMs);
+            json += buf;
+        }
+        return json + "}";
+    }
+
+    // Chrome trace_event JSON (chrome://tracing, Perfetto): one complete
+    // ("X") event per zone, one tid per recording thread.
+    bool writeChromeTrace(const char* path) {
+        FILE* f = fopen(path, "w");
+        if(!f) return false;
+        std::vector<Event> events = collect();
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", f);
+        for(size_t k=0; k<events.size(); k++) {
+            const Event& e = events[k];
+            fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    k ? "," : "", PROFILE_ZONE_NAMES[e.zone], (int)e.thread, e.start / 1e3, e.duration / 1e3);
+        }
+        fputs("\n]}\n", f);
+        return fclose(f) == 0;
+    }
+
+private:
+    static inline std::atomic<bool> recording{false}; // on, and the current frame is sampled
+
+    std::chrono::steady_clock::time_point epoch;
+    uint64_t epochTicks;
+    std::atomic<bool> on; // setEnabled()
+    int sampleInterval;
+    unsigned frame;
+    std::mutex ringsMutex;
+    std::vector<ProfileRing*> rings; // never freed: a finished thread's zones stay readable
+
+    Profiler() : epoch(std::chrono::steady_clock::now()), epochTicks(now()), on(false), sampleInterval(1), frame(0) {}
+
+    // Gives the calling thread its ring, once.
+    ProfileRing* registerThread() {
+        ProfileRing* ring = new ProfileRing();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(ring);
+        profileThreadRing = ring;
+        return ring;
+    }
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileZone z) : zone(z), start(Profiler::enabled() ? Profiler::now() : UINT64_MAX) {}
+    ~ProfileScope() { if(start != UINT64_MAX) Profiler::record(zone, start, Profiler::now()); }
+
+private:
+    ProfileZone zone;
+    uint64_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#if PROFILER_ENABLED
+#define PROFILE_ZONE(z) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(z)
+#else
+#define PROFILE_ZONE(z) ((void)0)
+#endif
+#endif
@@ -0,0 +1,48 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+#include <stdint.h>
+#include "ByteStream.h"
+
+// xoshiro128** generator. Each World owns one, so matches are reproducible
+// from their seed and independent worlds never share hidden global state.
+class Random {
+    uint32_t s[4];
+
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+public:
+    explicit Random(uint64_t seedValue = 1) { seed(seedValue); }
+
+    void seed(uint64_t seedValue) {
+        uint64_t a = splitmix64(seedValue);
+        uint64_t b = splitmix64(seedValue);
+        s[0] = (uint32_t)a; s[1] = (uint32_t)(a >> 32);
+        s[2] = (uint32_t)b; s[3] = (uint32_t)(b >> 32);
+    }
+
+    uint32_t next() {
+        uint32_t result = rotl(s[1] * 5, 7) * 9;
+        uint32_t t = s[1] << 9;
+        s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+
+    // Uniform int in [0, n); drop-in for rand() % n without the division.
+    int range(int n) { return (int)(((uint64_t)next() * (uint32_t)n) >> 32); }
+
+    void save(ByteWriter& w) const { for(int k=0; k<4; k++) w.u32(s[k]); }
+    void load(ByteReader& r) { for(int k=0; k<4; k++) s[k] = r.u32(); }
+
+    // Uniform float in [0, 1).
+    float unit() { return (next() >> 8) * (1.0f / 16777216.0f); }
+};
+#endif
@@ -1,69 +1,72 @@
 #ifndef SHADER_H
 #define SHADER_H
 
-#include <GLES3/gl3.h>
-#include <string.h>
+#include "../render/RenderDevice.h"
+#include "../render/ProgramCache.h"
 
 class Shader {
 public:
-    GLuint program;
-    GLint mvpHandle;
-    GLint posHandle;
-    GLint colorHandle;
-    GLint alphaHandle;
+    RenderDevice* device;
+    unsigned program;
+    int vpHandle;
+    int posHandle;
+    int modelHandle;  // mat4 attribute, occupies 4 consecutive locations
+    int colorHandle;  // per-instance rgb + alpha
+    bool fromCache;   // program came from a cached binary, not a compile
+    std::string error; // why init() failed
 
-    Shader() : program(0) {}
+    Shader() : device(NULL), program(0), fromCache(false) {}
 
-    GLuint loadShader(GLenum type, const char* src) {
-        GLuint shader = glCreateShader(type);
-        glShaderSource(shader, 1, &src, NULL);
-        glCompileShader(shader);
-        return shader;
-    }
-
-    void init() {
+    // Loads the program from `cache` when it holds a binary this driver
+    // accepts, else compiles and stores one. False, with the driver's log
+    // in `error`, if the sources don't compile or link.
+    bool init(RenderDevice* dev, ProgramCache* cache = NULL) {
+        device = dev;
 
         const char* vShader =
             "#version 300 es\n"
             "layout(location = 0) in vec3 aPos;\n"
-            "uniform mat4 uMVP;\n"
+            "layout(location = 1) in mat4 aModel;\n"
+            "layout(location = 5) in vec4 aColor;\n"
+            "uniform mat4 uVP;\n"
+            "out vec4 vColor;\n"
             "void main() {\n"
-            "   gl_Position = uMVP * vec4(aPos,1.0);\n"
+            "   vColor = aColor;\n"
+            "   gl_Position = uVP * aModel * vec4(aPos,1.0);\n"
             "}";
 
         const char* fShader =
             "#version 300 es\n"
             "precision mediump float;\n"
-            "uniform vec4 uColor;\n"
-            "uniform float uAlpha;\n"
+            "in vec4 vColor;\n"
             "out vec4 FragColor;\n"
             "void main() {\n"
-            "   FragColor = vec4(uColor.rgb, uAlpha);\n"
+            "   FragColor = vColor;\n"
             "}";
 
-        GLuint vs = loadShader(GL_VERTEX_SHADER, vShader);
-        GLuint fs = loadShader(GL_FRAGMENT_SHADER, fShader);
-
-        program = glCreateProgram();
-        glAttachShader(program, vs);
-        glAttachShader(program, fs);
-        glLinkProgram(program);
+        uint64_t key = 0;
+        program = 0;
+        if(cache) {
+            key = ProgramCache::key(device->driverId(), vShader, fShader);
+            program = cache->load(device, key);
+        }
+        fromCache = program != 0;
+        if(!program) {
+            program = device->createProgram(vShader, fShader);
+            if(!program) { error = device->programLog; return false; }
+            if(cache) cache->store(device, program, key);
+        }
+        error.clear();
 
-        glDeleteShader(vs);
-        glDeleteShader(fs);
-
-        mvpHandle = glGetUniformLocation(program, "uMVP");
-        colorHandle = glGetUniformLocation(program, "uColor");
-        alphaHandle = glGetUniformLocation(program, "uAlpha");
-        posHandle = 0; // location 0 (layout)
+        vpHandle = device->uniformLocation(program, "uVP");
+        posHandle = 0;   // locations fixed by layout qualifiers
+        modelHandle = 1;
+        colorHandle = 5;
+        return true;
     }
 
     void use() {
-        glUseProgram(program);
-    }
-
-    void setAlpha(float a) {
-        glUniform1f(alphaHandle, a);
+        device->useProgram(program);
     }
 };
 
@@ -0,0 +1,53 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SIMD_NEON 1
+#endif
+
+// Vectorized loops over structure-of-arrays pools. Array lengths passed in
+// must be padded to a multiple of 4; loads are unaligned so std::vector
+// storage is fine.
+namespace Simd {
+
+    // p += v * dt and life -= dt for n lanes, reference version.
+    inline void integrateScalar(float* px, float* py, float* pz,
+                                const float* vx, const float* vy, const float* vz,
+                                float* life, int n, float dt) {
+        for(int i=0; i<n; i++) {
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            pz[i] += vz[i] * dt;
+            life[i] -= dt;
+        }
+    }
+
+    inline void integrate(float* px, float* py, float* pz,
+                          const float* vx, const float* vy, const float* vz,
+                          float* life, int n, float dt) {
+#if defined(SIMD_SSE2)
+        __m128 d = _mm_set1_ps(dt);
+        for(int i=0; i<n; i+=4) {
+            _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(_mm_loadu_ps(vx + i), d)));
+            _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(_mm_loadu_ps(vy + i), d)));
+            _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(_mm_loadu_ps(vz + i), d)));
+            _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), d));
+        }
+#elif defined(SIMD_NEON)
+        float32x4_t d = vdupq_n_f32(dt);
+        for(int i=0; i<n; i+=4) {
+            vst1q_f32(px + i, vmlaq_f32(vld1q_f32(px + i), vld1q_f32(vx + i), d));
+            vst1q_f32(py + i, vmlaq_f32(vld1q_f32(py + i), vld1q_f32(vy + i), d));
+            vst1q_f32(pz + i, vmlaq_f32(vld1q_f32(pz + i), vld1q_f32(vz + i), d));
+            vst1q_f32(life + i, vsubq_f32(vld1q_f32(life + i), d));
+        }
+#else
+        integrateScalar(px, py, pz, vx, vy, vz, life, n, dt);
+#endif
+    }
+}
+#endif
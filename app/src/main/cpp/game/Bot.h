@@ -1,17 +1,56 @@
 #ifndef BOT_H
 #define BOT_H
+#include <vector>
 #include "Entity.h"
+#include "Map.h"
+#include "FlowField.h"
+#include "SpatialGrid.h"
+#include "SlotAllocator.h"
 
 enum class BotState { IDLE, ROAM, CHASE, ATTACK, FLEE };
 
+enum AiTier { AI_FULL, AI_MID, AI_FAR, AI_TIER_COUNT };
+
+// What a bot's AI wants to happen this tick. Positions and shots affect
+// other bots, so EntityManager commits them after every bot has decided.
+struct BotIntent {
+    Vec3 nextPos;
+    bool fire;
+    Vec3 fireDir;
+    uint8_t losRays, losCached; // line-of-sight queries cast / served from cache
+    bool scanned;               // ran the target scan, scheduled or forced
+};
+
+class Bot;
+
+// Read-only world state every bot's AI sees during one tick. Each mode's
+// EntityManager fills it with its own map, nav, slot and grid types.
+template<class MapT, class NavT, class SlotsT, class GridT>
+struct AiView {
+    const MapT* map;
+    const NavT* nav;             // toward the player
+    const Entity* player;
+    const Bot* bots;             // the bot pool, indexed by slot
+    const SlotsT* slots;
+    const GridT* grid;           // live bots at their start-of-tick positions
+    unsigned tick;
+};
+
 class Bot : public Entity {
 public:
     BotState state;
     float stateTimer;
-    Entity* target;
+    Handle target; // bot slot in the EntityManager pool, or Handle::player()
     Vec3 moveTarget;
     bool isBoss;
     float animTimer;
+    Random aiRng; // per-bot stream, so decisions don't depend on update order
+
+    // Line-of-sight cache: one entry for the player, one for the last bot
+    // looked at. An entry answers until tick `...Until`.
+    bool playerVisible, botVisible;
+    unsigned playerLosUntil, botLosUntil;
+    Handle botLosTarget;
 
     Bot() { type = EntityType::BOT; reset(); }
 
@@ -19,20 +58,51 @@ public:
         maxHp = 100.0f; hp = maxHp;
         speed = 7.0f;
         isDead = false;
+        fireTimer = 0.0f; fireRate = 0.5f;
         state = BotState::ROAM;
         stateTimer = 0.0f;
-        target = NULL;
+        target = Handle::none();
+        playerLosUntil = 0; botLosUntil = 0;
+        playerVisible = false; botVisible = false;
+        botLosTarget = Handle::none();
         isActive = false;
         isBoss = false; 
         animTimer = 0.0f;
-        
-        float r = (rand()%10)/10.0f;
-        float g = (rand()%10)/10.0f;
-        float b = (rand()%10)/10.0f;
-        color = Vec3(r, g, b);
         scaleV = Vec3(1, 1, 1);
     }
+
+    void spawn(Vec3 p, Random& rng) {
+        reset();
+        float r = rng.range(10)/10.0f;
+        float g = rng.range(10)/10.0f;
+        float b = rng.range(10)/10.0f;
+        color = Vec3(r, g, b);
+        pos = p; prevPos = p; isActive = true;
+        uint64_t hi = rng.next();
+        aiRng.seed((hi << 32) | rng.next());
+    }
     
+    void save(ByteWriter& w) const override {
+        Entity::save(w);
+        w.u8((uint8_t)state); w.pod(stateTimer);
+        target.save(w);
+        w.pod(moveTarget); w.u8(isBoss); w.pod(animTimer);
+        aiRng.save(w);
+        w.u8(playerVisible); w.u8(botVisible);
+        w.varint(playerLosUntil); w.varint(botLosUntil);
+        botLosTarget.save(w);
+    }
+    void load(ByteReader& r) override {
+        Entity::load(r);
+        state = (BotState)r.u8(); r.pod(stateTimer);
+        target.load(r);
+        r.pod(moveTarget); isBoss = r.u8() != 0; r.pod(animTimer);
+        aiRng.load(r);
+        playerVisible = r.u8() != 0; botVisible = r.u8() != 0;
+        playerLosUntil = (unsigned)r.varint(); botLosUntil = (unsigned)r.varint();
+        botLosTarget.load(r);
+    }
+
     void activateBossMode() {
         if (!isBoss) {
             isBoss = true;
@@ -45,7 +115,22 @@ public:
         }
     }
 
-    void updateAI(float dt, Map* map, Entity* player, std::vector<Bot>& otherBots) {
+    // Decides this tick from last tick's world: the grid and every bot's pos
+    // are the start-of-tick snapshot, and nothing here writes outside this
+    // bot, so all bots can decide in parallel. Movement and firing come back
+    // in `out`. selfId is this bot's slot. Without `rethink` the bot skips
+    // the target scan and state machine and keeps acting on its current
+    // target, unless that target is gone or out of sight, or it is attacking
+    // a target that has left BOT_ATTACK_RANGE. Targets are only
+    // taken, chased and shot with a clear line of sight. Chasing or fleeing
+    // the player follows v.nav around walls; bot-vs-bot steering stays
+    // direct.
+    template<class View>
+    void updateAI(float dt, const View& v, int selfId, bool rethink, BotIntent& out) {
+        out.nextPos = pos;
+        out.fire = false;
+        out.losRays = 0; out.losCached = 0;
+        out.scanned = false;
         if(isDead) return;
         
         stateTimer = fmax(0.0f, stateTimer - dt);
@@ -57,27 +142,44 @@ public:
         scaleV.x = (isBoss ? 1.3f : 1.0f) - (bounce * 0.5f);
         scaleV.z = scaleV.x;
 
-        float minDist = 25.0f; 
-        target = NULL;
-
-        if (!player->isDead) {
-            float d = (player->pos - pos).length();
-            if (d < minDist) { minDist = d; target = player; }
+        const Entity* targetEnt = NULL;
+        if (!rethink) {
+            targetEnt = followTarget(v.player, v.bots, *v.slots);
+            if (targetEnt && !canSee(v, target, targetEnt->pos, out)) targetEnt = NULL;
+            if (targetEnt == NULL && !target.isNone()) rethink = true;
+            else if (state == BotState::ATTACK && targetEnt &&
+                     (targetEnt->pos - pos).length() >= GameConfig::BOT_ATTACK_RANGE) rethink = true;
         }
+        out.scanned = rethink;
 
-        for(auto& b : otherBots) {
-            if(&b != this && !b.isDead && b.isActive) {
-                float d = (b.pos - pos).length();
-                if (d < minDist) { minDist = d; target = &b; }
+        if (rethink) {
+            float minDist = GameConfig::BOT_ACQUIRE_RANGE; 
+            targetEnt = NULL;
+            target = Handle::none();
+
+            const Entity* player = v.player;
+            if (!player->isDead) {
+                float d = (player->pos - pos).length();
+                if (d < minDist && canSee(v, Handle::player(), player->pos, out)) {
+                    minDist = d; targetEnt = player; target = Handle::player();
+                }
+            }
+
+            float botDist;
+            int nearestBot = v.grid->nearest(pos.x, pos.z, minDist, selfId, botDist);
+            if (nearestBot >= 0) {
+                Handle h = v.slots->handleOf(nearestBot);
+                const Bot& other = v.bots[nearestBot];
+                if (canSee(v, h, other.pos, out)) { minDist = botDist; targetEnt = &other; target = h; }
             }
-        }
 
-        if (hp < (maxHp * 0.3f)) state = BotState::FLEE;
-        else if (target != NULL) {
-            if (minDist < 8.0f) state = BotState::ATTACK;
-            else state = BotState::CHASE;
-        } else {
-             if (stateTimer <= 0.0f) state = BotState::ROAM;
+            if (hp < (maxHp * 0.3f)) state = BotState::FLEE;
+            else if (targetEnt != NULL) {
+                if (minDist < GameConfig::BOT_ATTACK_RANGE) state = BotState::ATTACK;
+                else state = BotState::CHASE;
+            } else {
+                 if (stateTimer <= 0.0f) state = BotState::ROAM;
+            }
         }
 
         Vec3 dir(0,0,0);
@@ -85,32 +187,69 @@ public:
             case BotState::ROAM:
                 if (stateTimer <= 0.0f) {
                     stateTimer = 3.0f;
-                    float angle = (rand()%360) * 0.017f;
+                    float angle = aiRng.range(360) * 0.017f;
                     moveTarget = pos + Vec3(cos(angle)*10, 0, sin(angle)*10);
                 }
                 dir = moveTarget - pos;
                 break;
             case BotState::CHASE:
-                if(target) dir = target->pos - pos;
+                if(targetEnt) dir = targetEnt->pos - pos;
+                if(v.nav && target.isPlayer()) { Vec3 d = v.nav->chaseDir(pos); if(d.length() > 0.0f) dir = d; }
                 break;
             case BotState::FLEE:
-                if(target) dir = pos - target->pos; 
+                if(targetEnt) dir = pos - targetEnt->pos; 
+                if(v.nav && target.isPlayer()) { Vec3 d = v.nav->fleeDir(pos); if(d.length() > 0.0f) dir = d; }
                 break;
             case BotState::ATTACK:
-                if(target) dir = target->pos - pos;
+                if(targetEnt) dir = targetEnt->pos - pos;
                 break;
         }
 
         if (state != BotState::ATTACK && dir.length() > 0.1f) {
             dir.normalize();
-            Vec3 nextPos = pos + (dir * speed * dt);
-            if (!map->checkCollision(nextPos, isBoss ? 1.5f : 1.0f)) {
-                pos = nextPos;
-            } else {
-                stateTimer = 0.0f; 
+            Vec3 step = dir * speed * dt;
+            out.nextPos = v.map->moveAndSlide(pos, step, isBoss ? 1.5f : 1.0f);
+            // Lost most of the step to a wall: give ROAM a fresh heading.
+            Vec3 moved = out.nextPos - pos;
+            if (moved.x*moved.x + moved.z*moved.z < 0.25f * (step.x*step.x + step.z*step.z)) stateTimer = 0.0f;
+        }
+
+        // Attackers stand still, so the shot leaves from pos either way.
+        if (state == BotState::ATTACK && fireTimer <= 0.0f && targetEnt) {
+            Vec3 aim = targetEnt->pos - pos;
+            if (aim.length() > 0.01f) {
+                aim.normalize();
+                out.fire = true;
+                out.fireDir = aim;
             }
         }
     }
+
+    // Clear line of sight to `h` at `at`, from the cache while it is fresh.
+    template<class View>
+    bool canSee(const View& v, Handle h, Vec3 at, BotIntent& out) {
+        if (h.isPlayer()) {
+            if (v.tick < playerLosUntil) { out.losCached++; return playerVisible; }
+            playerVisible = v.map->lineOfSight(pos, at);
+            playerLosUntil = v.tick + GameConfig::LOS_CACHE_TICKS;
+            out.losRays++;
+            return playerVisible;
+        }
+        if (h == botLosTarget && v.tick < botLosUntil) { out.losCached++; return botVisible; }
+        botVisible = v.map->lineOfSight(pos, at);
+        botLosTarget = h;
+        botLosUntil = v.tick + GameConfig::LOS_CACHE_TICKS;
+        out.losRays++;
+        return botVisible;
+    }
+
+    // The entity `target` still refers to, or NULL once it is dead or gone.
+    template<class Slots>
+    const Entity* followTarget(const Entity* player, const Bot* otherBots, const Slots& slots) const {
+        if (target.isPlayer()) return player->isDead ? NULL : player;
+        if (slots.isValid(target) && !otherBots[target.index].isDead) return &otherBots[target.index];
+        return NULL;
+    }
 };
 #endif
 
@@ -31,6 +31,19 @@ public:
         skinId = 0;
     }
 
+    void save(ByteWriter& w) const override {
+        GameObject::save(w);
+        w.pod(hp); w.pod(maxHp); w.pod(speed); w.u8(isDead);
+        w.svarint(kills); w.svarint(skinId);
+        w.pod(fireTimer); w.pod(fireRate); w.pod(weaponDmg); w.u8((uint8_t)weaponType);
+    }
+    void load(ByteReader& r) override {
+        GameObject::load(r);
+        r.pod(hp); r.pod(maxHp); r.pod(speed); isDead = r.u8() != 0;
+        kills = (int)r.svarint(); skinId = (int)r.svarint();
+        r.pod(fireTimer); r.pod(fireRate); r.pod(weaponDmg); weaponType = (WeaponType)r.u8();
+    }
+
     virtual void takeDamage(float amount) {
         if(isDead) return;
         hp -= amount;
@@ -1,81 +1,170 @@
 #ifndef ENTITY_MANAGER_H
 #define ENTITY_MANAGER_H
 #include "Bot.h"
+#include "Player.h"
 #include "WeaponSystem.h"
 #include "Map.h"
-
-class Particle : public GameObject {
-public:
-    Vec3 velocity;
-    float life;
-    void spawn(Vec3 p, Vec3 v, Vec3 c, float l) {
-        pos = p; velocity = v; color = c; life = l;
-        isActive = true; alpha = 1.0f; scaleV = Vec3(0.3f,0.3f,0.3f);
-    }
-    void update(float dt) override {
-        if(!isActive) return;
-        pos = pos + (velocity * dt);
-        life -= dt;
-        alpha = life; 
-        if(life <= 0.0f) isActive = false;
-    }
-};
+#include "ParticleSystem.h"
+#include "WorldMode.h"
+#include "../core/InlineVector.h"
+#include "../core/JobSystem.h"
+#include "../core/Profiler.h"
 
 struct KillFeed { bool active; float timer; float alpha; };
 
-class EntityManager {
+// Last tick's AI work: live bots per tier, how many ran a target scan
+// (on their slice or forced by a lost or out-of-range target), and
+// line-of-sight queries cast versus answered from the per-bot cache.
+struct AiStats { int bots[AI_TIER_COUNT]; int scans; int losRays; int losCached; };
+
+// Bots, their AI and the cosmetic particles of one match, sized by Mode
+// (see WorldMode.h).
+template<class Mode>
+class BasicEntityManager {
 public:
-    std::vector<Bot> bots;
-    std::vector<Particle> particles;
+    typedef BasicMap<Mode::MAP_SIZE> MapType;
+    typedef BasicFlowField<Mode::MAP_SIZE> NavType;
+    typedef BasicSlotAllocator<Mode::BOT_SLOTS> BotSlots;
+    typedef BasicSpatialGrid<Mode::MAP_SIZE, Mode::BOT_SLOTS> BotGrid;
+    typedef BasicWeaponSystem<Mode> WeaponSystemType;
+    typedef AiView<MapType, NavType, BotSlots, BotGrid> View;
+
+    PoolVector<Bot, Mode::BOT_SLOTS> bots; // indexed by botSlots; grows on demand unless fixed
+    BotSlots botSlots;
+    BasicParticleSystem<Mode::PARTICLE_SLOTS> particles;
     int botsAlive;
-    bool eventKill;
+    bool eventKill;     // latched for the UI until consumeKillEvent()
+    int killsThisTick;  // what the simulation reacts to; UI polling can't change it
     bool bossModeTriggered;
     bool eventBossKill; 
     KillFeed killFeed;
+    Random* rng; // owned by the World
+    BotGrid botGrid;
+    NavType nav; // toward the player, rebuilt when the player changes cell
+    bool playerFled; // some bot fled the player last tick, so keep nav's flee field built
+    PoolVector<BotIntent, Mode::BOT_SLOTS> intents; // indexed by bot slot, rewritten every tick
+    JobSystem* jobs; // not owned; NULL runs the AI on the calling thread
+    int aiGrain;     // bots per AI job
+    bool aiLod;      // false runs every bot at AI_FULL
+    unsigned aiTick;
+    PoolVector<uint8_t, Mode::BOT_SLOTS> botTier; // AiTier per bot slot, last tick
+    AiStats aiStats;
+    int droppedBots; // spawns a full fixed bot pool refused
 
-    EntityManager() {
-        bots.resize(40);
-        particles.resize(100);
+    BasicEntityManager(Random* r) : rng(r), jobs(NULL), aiGrain(64), aiLod(true), droppedBots(0) {
+        int botSlotCount = Mode::BOT_SLOTS ? Mode::BOT_SLOTS : GameConfig::BOT_SLOTS;
+        bots.resize(botSlotCount);
+        botSlots.reset(botSlotCount);
+        particles.resize(GameConfig::PARTICLE_SLOTS);
         reset();
     }
 
     void reset() {
-        botsAlive = 0; eventKill = false; eventBossKill = false;
+        botsAlive = 0; eventKill = false; killsThisTick = 0; eventBossKill = false;
         bossModeTriggered = false;
+        aiTick = 0;
+        memset(&aiStats, 0, sizeof(aiStats));
         killFeed.active = false; killFeed.timer = 0.0f; killFeed.alpha = 0.0f;
         for(auto& b : bots) b.isActive = false;
-        for(auto& p : particles) p.isActive = false;
+        botSlots.releaseAll();
+        particles.clear();
+        nav.invalidate();
+        playerFled = false;
+    }
+
+    // Match state only: intents, tiers and stats are rebuilt every tick.
+    void save(ByteWriter& w) const {
+        botSlots.save(w);
+        for(int i : botSlots.dense) bots[i].save(w);
+        particles.save(w);
+        w.varint(botsAlive); w.varint(killsThisTick); w.varint(aiTick);
+        w.u8(eventKill); w.u8(bossModeTriggered); w.u8(eventBossKill); w.u8(playerFled);
+        w.u8(killFeed.active); w.pod(killFeed.timer); w.pod(killFeed.alpha);
+        nav.save(w);
+    }
+
+    // `map` must already hold the restored layout: the flow field is
+    // rebuilt from it rather than stored.
+    bool load(ByteReader& r, const MapType& map) {
+        if(!botSlots.load(r)) return false;
+        bots.resize(botSlots.capacity());
+        for(auto& b : bots) b.isActive = false;
+        for(int i : botSlots.dense) bots[i].load(r);
+        if(!particles.load(r)) return false;
+        botsAlive = (int)r.varint(); killsThisTick = (int)r.varint(); aiTick = (unsigned)r.varint();
+        eventKill = r.u8() != 0; bossModeTriggered = r.u8() != 0; eventBossKill = r.u8() != 0; playerFled = r.u8() != 0;
+        killFeed.active = r.u8() != 0; r.pod(killFeed.timer); r.pod(killFeed.alpha);
+        nav.load(r, map);
+        memset(&aiStats, 0, sizeof(aiStats));
+        return r.ok;
     }
 
-    void spawnEffect(Vec3 p, Vec3 color) {
-        for(auto& part : particles) {
-            if(!part.isActive) {
-                float vx = (rand()%20 - 10) * 0.2f;
-                float vy = (rand()%10) * 0.3f + 1.0f;
-                float vz = (rand()%20 - 10) * 0.2f;
-                part.spawn(p, Vec3(vx, vy, vz), color, 0.8f);
-                return;
+    // Particle motion still comes from the match rng, three draws each, so
+    // effects stay part of the recorded, replayable stream.
+    Vec3 effectVelocity() {
+        float vx = (rng->range(20) - 10) * 0.2f;
+        float vy = rng->range(10) * 0.3f + 1.0f;
+        float vz = (rng->range(20) - 10) * 0.2f;
+        return Vec3(vx, vy, vz);
+    }
+
+    void spawnEffect(Vec3 p, int emitter) { particles.spawn(p, effectVelocity(), emitter); }
+
+    // One reservation for the whole burst.
+    void spawnBurst(Vec3 p, int emitter, int count) {
+        uint32_t first = particles.reserve(count);
+        for(int k=0; k<count; k++) particles.place(particles.lane(first + k), p, effectVelocity(), emitter);
+    }
+
+    // -1 when a fixed pool is full.
+    int acquireBot() {
+        int slot = botSlots.acquire();
+        if(slot < 0) {
+            if constexpr(Mode::BOT_SLOTS != 0) {
+                droppedBots++;
+            } else {
+                int grown = botSlots.capacity() < 8 ? 16 : botSlots.capacity() * 2;
+                botSlots.grow(grown);
+                bots.resize(grown);
+                slot = botSlots.acquire();
             }
         }
-    }
-    
-    void spawnBurst(Vec3 p, Vec3 color, int count) {
-        for(int i=0; i<count; i++) spawnEffect(p, color);
+        return slot;
     }
 
+    // Bots land anywhere in the middle half of the map on each axis, away
+    // from the player's start.
     void spawnBots(int count) { 
-        if(count > 40) count = 40;
+        const int half = (int)(MapType::OFFSET / 2);
         for(int i=0; i<count; i++) {
-            for(auto& b : bots) {
-                if(!b.isActive) {
-                    b.reset(); b.isActive = true;
-                    int a=0; float x,z; 
-                    do { x=(rand()%100)-50.0f; z=(rand()%100)-50.0f; a++; } while(abs(x)<5 && abs(z)<5 && a<10);
-                    b.pos = Vec3(x,0,z); botsAlive++; break;
-                }
-            }
+            int slot = acquireBot();
+            if(slot < 0) break;
+            Bot& b = bots[slot];
+            int a=0; float x,z; 
+            do { x=rng->range(2*half)-(float)half; z=rng->range(2*half)-(float)half; a++; } while(abs(x)<5 && abs(z)<5 && a<10);
+            b.spawn(Vec3(x,0,z), *rng); botsAlive++;
         }
     }
+
+    // On-screen or near bots get full AI; see GameConfig for the tiers.
+    int lodTier(const Bot& b, const Player* player) const {
+        if(!aiLod) return AI_FULL;
+        float dx = b.pos.x - player->pos.x, dz = b.pos.z - player->pos.z;
+        if(fabsf(dx) < GameConfig::VIEW_HALF_WIDTH && dz > -GameConfig::VIEW_AHEAD && dz < GameConfig::VIEW_BEHIND) return AI_FULL;
+        float dSq = dx*dx + dz*dz;
+        if(dSq < GameConfig::AI_NEAR_RANGE * GameConfig::AI_NEAR_RANGE) return AI_FULL;
+        if(dSq < GameConfig::AI_FAR_RANGE * GameConfig::AI_FAR_RANGE) return AI_MID;
+        return AI_FAR;
+    }
+
+    // Slot-staggered so a tier's work is spread evenly over its interval.
+    bool onSlice(int slot, int interval) const { return (aiTick + (unsigned)slot) % (unsigned)interval == 0; }
+
+    Entity* resolveTarget(Handle h, Player* player) {
+        if(h.isPlayer()) return player;
+        if(botSlots.isValid(h)) return &bots[h.index];
+        return NULL;
+    }
     
     bool consumeKillEvent() { if(eventKill){ eventKill=false; return true; } return false; }
     
@@ -85,7 +174,8 @@ public:
         killFeed.alpha = 1.0f;
     }
 
-    void update(float dt, Map* map, Player* player, WeaponSystem* ws) {
+    void update(float dt, const MapType* map, Player* player, WeaponSystemType* ws) {
+        killsThisTick = 0;
         if (killFeed.active) {
             killFeed.timer = fmax(0.0f, killFeed.timer - dt);
             if (killFeed.timer < 0.5f) killFeed.alpha = killFeed.timer / 0.5f; 
@@ -97,73 +187,149 @@ public:
             if (killFeed.timer <= 0.0f) { killFeed.active = false; killFeed.alpha = 0.0f; }
         }
 
-        int currentAlive = 0;
-        for(auto& b : bots) {
-            if(!b.isActive) continue;
-            if(!b.isDead) {
-                currentAlive++;
-                b.updateAI(dt, map, player, bots);
-                
-                if(b.state == BotState::ATTACK && b.fireTimer <= 0.0f && b.target) {
-                     Vec3 dir = b.target->pos - b.pos; 
-                     if(dir.length() > 0.01f) {
-                         dir.normalize();
-                         ws->fire(b.pos, dir, false, WeaponType::PISTOL); 
-                         b.fireTimer = b.isBoss ? 0.5f : (1.0f + (rand()%100)/100.0f);
-                     }
+        updateBots(dt, map, player, ws);
+        {
+            PROFILE_ZONE(PZ_COLLISION);
+            collideBullets(player, ws);
+        }
+        {
+            PROFILE_ZONE(PZ_PARTICLES);
+            particles.update(dt, jobs);
+        }
+    }
+
+    // Bot AI for one tick: decide in parallel, commit in slot order.
+    void updateBots(float dt, const MapType* map, Player* player, WeaponSystemType* ws) {
+        PROFILE_ZONE(PZ_AI);
+        botGrid.clear((int)bots.size());
+        for(int i : botSlots.dense) {
+            if(!bots[i].isDead) botGrid.insert(i, bots[i].pos);
+        }
+
+        {
+            PROFILE_ZONE(PZ_NAV);
+            nav.update(*map, player->pos);
+            if(playerFled) nav.ensureFlee();
+        }
+
+        // Every bot decides against the start-of-tick snapshot (botGrid and
+        // the untouched positions), in parallel when a JobSystem is set...
+        intents.resize(bots.size());
+        botTier.resize(bots.size());
+        const auto& live = botSlots.dense;
+        const View view = { map, &nav, player, bots.data(), &botSlots, &botGrid, aiTick };
+        auto think = [&](int begin, int end) {
+            PROFILE_ZONE(PZ_AI_JOB);
+            for(int k=begin; k<end; k++) {
+                int i = live[k];
+                Bot& b = bots[i];
+                int tier = lodTier(b, player);
+                botTier[i] = (uint8_t)tier;
+                if(tier == AI_FULL) {
+                    b.updateAI(dt, view, i, true, intents[i]);
+                } else if(tier == AI_MID) {
+                    b.updateAI(dt, view, i, onSlice(i, GameConfig::AI_MID_INTERVAL), intents[i]);
+                } else if(onSlice(i, GameConfig::AI_FAR_INTERVAL)) {
+                    // One coarse step covering the whole interval.
+                    b.updateAI(dt * GameConfig::AI_FAR_INTERVAL, view, i, true, intents[i]);
+                } else {
+                    intents[i].nextPos = b.pos;
+                    intents[i].fire = false;
+                    intents[i].losRays = 0; intents[i].losCached = 0;
+                    intents[i].scanned = false;
                 }
             }
+        };
+        if(jobs) jobs->parallelFor((int)live.size(), aiGrain, think);
+        else think(0, (int)live.size());
+
+        // ...then moves and shots are committed in slot order, so bullets
+        // and rng draws come out the same for any thread count.
+        int currentAlive = 0;
+        playerFled = false;
+        memset(&aiStats, 0, sizeof(aiStats));
+        for(int i : live) {
+            Bot& b = bots[i];
+            if(b.isDead) continue;
+            currentAlive++;
+            int tier = botTier[i];
+            aiStats.bots[tier]++;
+            if(b.state == BotState::FLEE && b.target.isPlayer()) playerFled = true;
+            const BotIntent& in = intents[i];
+            aiStats.scans += in.scanned;
+            aiStats.losRays += in.losRays;
+            aiStats.losCached += in.losCached;
+            b.pos = in.nextPos;
+            if(in.fire) {
+                ws->fire(b.pos, in.fireDir, false, WeaponType::PISTOL);
+                b.fireTimer = b.isBoss ? 0.5f : (1.0f + rng->range(100)/100.0f);
+            }
         }
         botsAlive = currentAlive;
+        aiTick++;
         if(botsAlive < 0) botsAlive = 0;
 
         if (!bossModeTriggered && botsAlive > 0 && botsAlive <= 3) {
             bossModeTriggered = true;
-            for(auto& b : bots) if(b.isActive && !b.isDead) b.activateBossMode();
+            for(int i : botSlots.dense) if(!bots[i].isDead) bots[i].activateBossMode();
         }
+    }
 
-        for(auto& bullet : ws->bullets) {
-            if(!bullet.isActive) continue;
-
-            if(bullet.isPlayerBullet) {
-                for(auto& b : bots) {
-                    if(b.isActive && !b.isDead && checkCircleCollision(bullet.pos, 0.5f, b.pos, b.isBoss ? 1.5f : 1.0f)) {
-                        float dmg = 20.0f;
-                        if(bullet.type == WeaponType::BEAM) dmg = 50.0f;
-                        if(bullet.type == WeaponType::SHOTGUN) dmg = 10.0f;
-                        if(player->ultActive) dmg *= 2.0f;
-                        
-                        b.takeDamage(dmg);
-                        bullet.isActive = false;
-                        
-                        if(b.isDead) { 
-                            eventKill = true; 
-                            triggerKillFeed();
-                            if(b.isBoss) {
-                                eventBossKill = true;
-                                spawnBurst(b.pos, Vec3(0.5f, 0, 0), 20);
-                            } else {
-                                spawnEffect(b.pos, Vec3(1,0,0));
-                            }
-                        } 
-                    }
+    // Resolves every live bullet against bots and the player. Broadphase:
+    // re-bucket live bots at their post-move positions, then each player
+    // bullet only tests bots in the cells it overlaps.
+    void collideBullets(Player* player, WeaponSystemType* ws) {
+        botGrid.clear((int)bots.size());
+        for(int i : botSlots.dense) {
+            if(!bots[i].isDead) botGrid.insert(i, bots[i].pos);
+        }
+
+        auto& bp = ws->bullets;
+        for(int k=bp.count()-1; k>=0; k--) {
+            int bi = bp.slots.dense[k];
+            Vec3 bulletPos = bp.pos(bi);
+
+            if(bp.isPlayerBullet[bi]) {
+                // A bullet hits at most one bot: the lowest-index one it overlaps.
+                int hit = -1;
+                botGrid.forEachNear(bulletPos.x, bulletPos.z, 0.5f + 1.5f, [&](int id) {
+                    Bot& b = bots[id];
+                    if((hit < 0 || id < hit) && !b.isDead &&
+                       checkCircleCollision(bulletPos, 0.5f, b.pos, b.isBoss ? 1.5f : 1.0f)) hit = id;
+                });
+                if(hit >= 0) {
+                    Bot& b = bots[hit];
+                    float dmg = 20.0f;
+                    if(bp.type[bi] == WeaponType::BEAM) dmg = 50.0f;
+                    if(bp.type[bi] == WeaponType::SHOTGUN) dmg = 10.0f;
+                    if(player->ultActive) dmg *= 2.0f;
+                    
+                    b.takeDamage(dmg);
+                    bp.kill(bi);
+                    
+                    if(b.isDead) { 
+                        eventKill = true;
+                        killsThisTick++;
+                        triggerKillFeed();
+                        if(b.isBoss) {
+                            eventBossKill = true;
+                            spawnBurst(b.pos, EMIT_BOSS_KILL, 20);
+                        } else {
+                            spawnEffect(b.pos, EMIT_KILL);
+                        }
+                    } 
                 }
             } else {
-                if(!player->isDead && checkCircleCollision(bullet.pos, 0.5f, player->pos, 1.0f)) {
+                if(!player->isDead && checkCircleCollision(bulletPos, 0.5f, player->pos, 1.0f)) {
                     player->takeDamage(5.0f);
-                    bullet.isActive = false;
-                    spawnEffect(player->pos, Vec3(1,0,0));
+                    bp.kill(bi);
+                    spawnEffect(player->pos, EMIT_HIT);
                 }
             }
         }
-        
-        for(auto& p : particles) p.update(dt);
-    }
-
-    void draw(Shader* s, Mat4& vp) {
-        for(auto& b : bots) b.draw(s, vp);
-        for(auto& p : particles) p.draw(s, vp);
     }
 };
+
+typedef BasicEntityManager<StandardMode> EntityManager;
 #endif
 
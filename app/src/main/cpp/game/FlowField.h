@@ -0,0 +1,231 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include "Map.h"
+
+// Shared navigation toward (and away from) one goal over the Map cells. The
+// chase field is an 8-connected Dijkstra distance from the goal cell; the
+// flee field seeds every cell with -FLEE_WEIGHT x its chase distance and
+// relaxes again, so fleeing bots head for open space rather than the
+// nearest dead end. Each cell stores the neighbour it was reached from,
+// i.e. the next step of its best path, so a bot samples its direction in
+// O(1). The chase field is rebuilt only when the goal changes cell or the
+// map layout changes; the flee field is built on request (ensureFlee) for
+// the current goal, since few bots ever flee. The legal steps out of each
+// cell are cached per layout. Fields, and the queue they are relaxed
+// through, are fixed arrays over the SIZE x SIZE map, so a rebuild never
+// allocates.
+template<int SIZE>
+class BasicFlowField {
+public:
+    static constexpr int N = SIZE;
+    static constexpr int CELLS = N * N;
+    static constexpr int STRAIGHT = 10, DIAGONAL = 14; // step costs, cell = 10
+    static constexpr int FLEE_WEIGHT_X10 = 12;         // flee seed = -1.2 x chase distance
+    static constexpr int UNREACHABLE = 0x3FFFFFFF;
+
+    typedef BasicMap<SIZE> MapType;
+    typedef std::array<int, CELLS> CostField;
+    typedef std::array<int16_t, CELLS> NextField;
+
+    CostField chaseCost, fleeCost; // per cell, index i * N + j for Map cell (i, j)
+    NextField chaseNext, fleeNext; // next cell to step to, -1 at a goal or when stuck
+    std::array<uint8_t, CELLS> stepMask; // bit k: step k out of the cell is legal
+    int goalCell;
+    unsigned mapRevision;
+    int rebuilds;
+    bool fleeBuilt;
+
+    BasicFlowField() : goalCell(-1), mapRevision(0), rebuilds(0), fleeBuilt(false), seedCount(0) {
+        chaseCost.fill(UNREACHABLE); fleeCost.fill(UNREACHABLE);
+        chaseNext.fill(-1); fleeNext.fill(-1);
+        stepMask.fill(0);
+        queued.fill(0);
+        queueHead.fill(-1); queueTail.fill(-1);
+    }
+
+    static int cellOf(Vec3 p) {
+        float offset = (N * GameConfig::CELL_SIZE) / 2.0f;
+        int i = (int)floorf((p.x + offset) / GameConfig::CELL_SIZE + 0.5f);
+        int j = (int)floorf((p.z + offset) / GameConfig::CELL_SIZE + 0.5f);
+        if(i < 0) i = 0;
+        if(i >= N) i = N - 1;
+        if(j < 0) j = 0;
+        if(j >= N) j = N - 1;
+        return i * N + j;
+    }
+
+    static Vec3 cellCenter(int cell) {
+        float offset = (N * GameConfig::CELL_SIZE) / 2.0f;
+        return Vec3((cell / N) * GameConfig::CELL_SIZE - offset, 0, (cell % N) * GameConfig::CELL_SIZE - offset);
+    }
+
+    void invalidate() { goalCell = -1; }
+
+    // Only the goal and whether flee was built: both fields are a pure
+    // function of those and the map, and rebuilding takes microseconds.
+    void save(ByteWriter& w) const { w.svarint(goalCell); w.u8(fleeBuilt); }
+
+    void load(ByteReader& r, const MapType& map) {
+        int goal = (int)r.svarint();
+        bool flee = r.u8() != 0;
+        invalidate();
+        if(goal < 0 || goal >= N * N) return;
+        rebuild(map, goal);
+        if(flee) ensureFlee();
+    }
+
+    // Rebuilds when `goal` has moved to another cell or the map changed.
+    // Returns true if it rebuilt.
+    bool update(const MapType& map, Vec3 goal) {
+        int cell = cellOf(goal);
+        if(cell == goalCell && map.revision == mapRevision) return false;
+        rebuild(map, cell);
+        return true;
+    }
+
+    void rebuild(const MapType& map, int goal) {
+        if(goalCell < 0 || map.revision != mapRevision) buildSteps(map);
+        goalCell = goal;
+        mapRevision = map.revision;
+        rebuilds++;
+
+        std::fill(chaseCost.begin(), chaseCost.end(), UNREACHABLE);
+        std::fill(chaseNext.begin(), chaseNext.end(), -1);
+        if(walkable(map, goal / N, goal % N)) {
+            chaseCost[goal] = 0;
+            seed(0, goal);
+        }
+        relax(chaseCost, chaseNext, 0);
+        fleeBuilt = false;
+    }
+
+    void ensureFlee() {
+        if(fleeBuilt || goalCell < 0) return;
+        fleeBuilt = true;
+        int lo = 0;
+        for(int c=0; c<N*N; c++) {
+            fleeCost[c] = chaseCost[c] >= UNREACHABLE ? UNREACHABLE : -(chaseCost[c] * FLEE_WEIGHT_X10) / 10;
+            if(fleeCost[c] < lo) lo = fleeCost[c];
+        }
+        for(int c=0; c<N*N; c++) if(fleeCost[c] < UNREACHABLE) seed(fleeCost[c] - lo, c);
+        std::fill(fleeNext.begin(), fleeNext.end(), -1);
+        relax(fleeCost, fleeNext, lo);
+    }
+
+    // Unit XZ direction from p toward the next cell's centre, or zero when p
+    // is in the goal cell, has no route, or the flee field isn't built yet
+    // (callers then steer directly).
+    Vec3 chaseDir(Vec3 p) const { return stepDir(p, chaseNext); }
+    Vec3 fleeDir(Vec3 p) const { return fleeBuilt ? stepDir(p, fleeNext) : Vec3(0, 0, 0); }
+
+private:
+    // Queued cells have a cost within one step of the cost being expanded,
+    // so WINDOW buckets used round-robin hold them all.
+    static constexpr int WINDOW = DIAGONAL + 1;
+
+    std::array<int64_t, CELLS> seedKeys; // (cost - lo) << 16 | cell
+    int seedCount;
+    std::array<int16_t, CELLS> queueNext, queuePrev; // FIFO per bucket, linked through the cells
+    std::array<uint8_t, CELLS> queued;
+    std::array<int16_t, WINDOW> queueHead, queueTail;
+
+    void seed(int bucket, int cell) { seedKeys[seedCount++] = ((int64_t)bucket << 16) | cell; }
+
+    void enqueue(int bucket, int cell) {
+        int slot = bucket % WINDOW;
+        queueNext[cell] = -1;
+        queuePrev[cell] = queueTail[slot];
+        if(queueTail[slot] >= 0) queueNext[queueTail[slot]] = (int16_t)cell;
+        else queueHead[slot] = (int16_t)cell;
+        queueTail[slot] = (int16_t)cell;
+        queued[cell] = 1;
+    }
+
+    void dequeue(int bucket, int cell) {
+        int slot = bucket % WINDOW;
+        if(queuePrev[cell] >= 0) queueNext[queuePrev[cell]] = queueNext[cell];
+        else queueHead[slot] = queueNext[cell];
+        if(queueNext[cell] >= 0) queuePrev[queueNext[cell]] = queuePrev[cell];
+        else queueTail[slot] = queuePrev[cell];
+        queued[cell] = 0;
+    }
+
+    static bool walkable(const MapType& map, int i, int j) {
+        return i >= 0 && i < N && j >= 0 && j < N && !map.isWall(i, j);
+    }
+
+    static constexpr int STEP_DI[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    static constexpr int STEP_DJ[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+    // Diagonal steps need both orthogonal cells open, so nobody cuts a corner.
+    void buildSteps(const MapType& map) {
+        for(int c=0; c<N*N; c++) {
+            int i = c / N, j = c % N;
+            uint8_t mask = 0;
+            for(int k=0; k<8; k++) {
+                int ni = i + STEP_DI[k], nj = j + STEP_DJ[k];
+                if(!walkable(map, ni, nj)) continue;
+                if(k >= 4 && (!walkable(map, ni, j) || !walkable(map, i, nj))) continue;
+                mask |= (uint8_t)(1 << k);
+            }
+            stepMask[c] = mask;
+        }
+    }
+
+    template<class Fn>
+    void forEachStep(int cell, Fn fn) const {
+        for(unsigned mask = stepMask[cell]; mask; mask &= mask - 1) {
+            int k = __builtin_ctz(mask);
+            fn(cell + STEP_DI[k] * N + STEP_DJ[k], k < 4 ? STRAIGHT : DIAGONAL);
+        }
+    }
+
+    // Dijkstra from the seeds, with one bucket per integer cost (Dial's
+    // algorithm): steps are small positive integers, so buckets are visited
+    // in order with no heap. `lo` is the cost of bucket 0. Within a bucket,
+    // seeds go first in cell order, then cells in the order they reached
+    // that cost. Each improved cell records the cell it was reached from in
+    // `next`.
+    void relax(CostField& cost, NextField& next, int lo) {
+        std::sort(seedKeys.begin(), seedKeys.begin() + seedCount);
+        int s = 0, pending = 0;
+        auto expand = [&](int cell, int c) {
+            forEachStep(cell, [&](int n, int step) {
+                if(c + step >= cost[n]) return;
+                if(queued[n]) { dequeue(cost[n] - lo, n); pending--; }
+                cost[n] = c + step;
+                next[n] = (int16_t)cell;
+                enqueue(c + step - lo, n);
+                pending++;
+            });
+        };
+        for(int b=0; s < seedCount || pending > 0; b++) {
+            if(pending == 0) b = std::max(b, (int)(seedKeys[s] >> 16));
+            for(; s < seedCount && (int)(seedKeys[s] >> 16) == b; s++) {
+                int cell = (int)(seedKeys[s] & 0xFFFF);
+                if(cost[cell] == b + lo) expand(cell, b + lo); // else improved since seeding
+            }
+            for(int slot = b % WINDOW; queueHead[slot] >= 0; pending--) {
+                int cell = queueHead[slot];
+                dequeue(b, cell);
+                expand(cell, b + lo);
+            }
+        }
+        seedCount = 0;
+    }
+
+    static Vec3 stepDir(Vec3 p, const NextField& next) {
+        int n = next[cellOf(p)];
+        if(n < 0) return Vec3(0, 0, 0);
+        Vec3 d = cellCenter(n) - p;
+        d.y = 0.0f;
+        d.normalize();
+        return d;
+    }
+};
+
+typedef BasicFlowField<GameConfig::MAP_SIZE> FlowField;
+#endif
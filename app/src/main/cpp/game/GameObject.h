@@ -1,12 +1,11 @@
 #ifndef GAME_OBJECT_H
 #define GAME_OBJECT_H
 #include "../core/MathUtils.h"
-#include "../core/Shader.h"
+#include "../core/Random.h"
 
 namespace GameConfig {
     constexpr int MAP_SIZE = 50;
     constexpr float CELL_SIZE = 4.0f;
-    constexpr float WALL_CULL_SQ = 2500.0f;
 
     constexpr float PLAYER_BASE_HP = 100.0f;
     constexpr float PLAYER_BASE_SPEED = 8.0f;
@@ -20,6 +19,37 @@ namespace GameConfig {
     constexpr float BULLET_SPEED_STD = 30.0f;
     constexpr float BULLET_SPEED_BEAM = 60.0f;
     constexpr float SHOTGUN_SPREAD = 0.15f;
+
+    constexpr int BOT_COUNT = 30;
+    constexpr int MAX_BOTS = 4096; // per match; a world or snapshot asking for more is refused
+    // Starting pool sizes; pools double when a spawn finds them full. The
+    // particle ring rounds up to a power of two.
+    constexpr int BOT_SLOTS = 40;
+    constexpr int BULLET_SLOTS = 100;
+    constexpr int PARTICLE_SLOTS = 128;
+    constexpr float BOT_ACQUIRE_RANGE = 25.0f;
+    constexpr float BOT_ATTACK_RANGE = 8.0f; // closer than this a bot stops and shoots
+    constexpr int LOS_CACHE_TICKS = 4; // a bot reuses a line-of-sight answer for the same target this long
+
+    // AI level of detail. Bots on screen or within AI_NEAR_RANGE think every
+    // tick; out to AI_FAR_RANGE they re-pick targets every AI_MID_INTERVAL
+    // ticks; beyond that they think and move once per AI_FAR_INTERVAL ticks
+    // with one coarse step. The view box is the camera's ground footprint
+    // around the player (camera 25 up, 18 back, landscape).
+    constexpr float AI_NEAR_RANGE = 30.0f;
+    constexpr float AI_FAR_RANGE = 60.0f;
+    constexpr int AI_MID_INTERVAL = 4;
+    constexpr int AI_FAR_INTERVAL = 8;
+    constexpr float VIEW_HALF_WIDTH = 36.0f;
+    constexpr float VIEW_AHEAD = 32.0f;  // towards -z
+    constexpr float VIEW_BEHIND = 20.0f; // towards +z
+
+    // Simulation runs at a fixed rate regardless of display refresh; a
+    // frame longer than MAX_FRAME_DT is treated as MAX_FRAME_DT.
+    constexpr int SIM_HZ = 60;
+    constexpr int MIN_SIM_HZ = 10;   // World::update never steps more than 100 ms
+    constexpr int MAX_SIM_HZ = 1000; // ... or less than 1 ms
+    constexpr float MAX_FRAME_DT = 0.25f;
     
     constexpr float ZONE_START_RADIUS = 100.0f;
     constexpr float ZONE_MIN_RADIUS = 15.0f;
@@ -33,42 +63,27 @@ enum class WeaponType {
     BEAM 
 };
 
-static const float CUBE[] = { 
-    -0.5f,-0.5f,0.5f, 0.5f,-0.5f,0.5f, 0.5f,0.5f,0.5f, 0.5f,0.5f,0.5f, -0.5f,0.5f,0.5f, -0.5f,-0.5f,0.5f,
-    -0.5f,-0.5f,-0.5f, -0.5f,0.5f,-0.5f, 0.5f,0.5f,-0.5f, 0.5f,0.5f,-0.5f, 0.5f,-0.5f,-0.5f, -0.5f,-0.5f,-0.5f,
-    -0.5f,0.5f,-0.5f, -0.5f,0.5f,0.5f, 0.5f,0.5f,0.5f, 0.5f,0.5f,0.5f, 0.5f,0.5f,-0.5f, -0.5f,0.5f,-0.5f,
-    -0.5f,-0.5f,-0.5f, 0.5f,-0.5f,-0.5f, 0.5f,-0.5f,0.5f, 0.5f,-0.5f,0.5f, -0.5f,-0.5f,0.5f, -0.5f,-0.5f,-0.5f,
-    0.5f,-0.5f,-0.5f, 0.5f,0.5f,-0.5f, 0.5f,0.5f,0.5f, 0.5f,0.5f,0.5f, 0.5f,-0.5f,0.5f, 0.5f,-0.5f,-0.5f,
-    -0.5f,-0.5f,-0.5f, -0.5f,-0.5f,0.5f, -0.5f,0.5f,0.5f, -0.5f,0.5f,0.5f, -0.5f,0.5f,-0.5f, -0.5f,-0.5f,-0.5f
-};
-
 class GameObject {
 public:
     Vec3 pos, scaleV, color;
+    Vec3 prevPos; // pos at the start of the last fixed tick
     float alpha;
     bool isActive;
 
     GameObject() : isActive(false), scaleV(1,1,1), color(1,1,1), alpha(1.0f) {}
     virtual ~GameObject() {}
+
+    // Position t of the way through the last tick (0 = prevPos, 1 = pos).
+    Vec3 renderPos(float t) const { return prevPos + (pos - prevPos) * t; }
     
-    virtual void update(float dt) {} 
+    virtual void update(float dt) {}
 
-    void draw(Shader* s, Mat4& vp) {
-        if (!isActive) return;
-        Mat4 model; // Identity
-        Mat4::translate(model, pos.x, pos.y, pos.z);
-        Mat4::scale(model, scaleV.x, scaleV.y, scaleV.z);
-        
-        Mat4 mvp;
-        Mat4::multiply(mvp, vp, model); // mvp = vp * model
-        
-        glUniformMatrix4fv(s->mvpHandle, 1, GL_FALSE, mvp.m);
-        glUniform4f(s->colorHandle, color.x, color.y, color.z, 1.0f);
-        s->setAlpha(alpha);
-        
-        glVertexAttribPointer(s->posHandle, 3, GL_FLOAT, GL_FALSE, 0, CUBE);
-        glEnableVertexAttribArray(s->posHandle);
-        glDrawArrays(GL_TRIANGLES, 0, 36); 
+    // Snapshot fields. Subclasses call up first, then append their own.
+    virtual void save(ByteWriter& w) const {
+        w.pod(pos); w.pod(prevPos); w.pod(scaleV); w.pod(color); w.pod(alpha); w.u8(isActive);
+    }
+    virtual void load(ByteReader& r) {
+        r.pod(pos); r.pod(prevPos); r.pod(scaleV); r.pod(color); r.pod(alpha); isActive = r.u8() != 0;
     }
 };
 #endif
@@ -0,0 +1,153 @@
+#ifndef KINEMATIC_POOL_H
+#define KINEMATIC_POOL_H
+#include <stdint.h>
+#include <vector>
+#include "GameObject.h"
+#include "SlotAllocator.h"
+#include "../core/InlineVector.h"
+#include "../core/SimdKernels.h"
+
+// Structure-of-arrays storage for short-lived objects that fly in a straight
+// line until their life runs out (bullets, particles). The hot arrays hold
+// only what the integrator touches. Derived pools keep their per-slot
+// extras in parallel arrays of their own. Slots come from a free list. With
+// CAPACITY 0 the pool doubles when it runs out, so spawns are never
+// dropped; a fixed pool of CAPACITY slots keeps every array inline, runs
+// the integrator over a constant LANES, and refuses (and counts) a spawn
+// that finds it full.
+template<int CAPACITY>
+class BasicKinematicPool {
+public:
+    static constexpr int LANES = (CAPACITY + 3) & ~3; // hot arrays of a fixed pool
+
+    BasicSlotAllocator<CAPACITY> slots;
+    PoolVector<float, LANES> px, py, pz;
+    PoolVector<float, LANES> vx, vy, vz;
+    PoolVector<float, LANES> life;
+    PoolVector<float, LANES> prevX, prevY, prevZ; // positions at the start of the last fixed tick
+    int dropped; // spawns a full fixed pool refused
+
+    BasicKinematicPool() : dropped(0) {}
+    virtual ~BasicKinematicPool() {}
+
+    int capacity() const { return slots.capacity(); }
+    int count() const { return slots.count(); }
+    bool isActive(int i) const { return slots.isLive(i); }
+    int lanes() const { return CAPACITY ? LANES : (int)px.size(); }
+
+    // Drop everything and size the pool for n slots; a fixed pool always
+    // holds CAPACITY.
+    void resize(int n) {
+        if(CAPACITY) n = CAPACITY;
+        slots.reset(n);
+        resizeStorage(n);
+        for(size_t i=0; i<vx.size(); i++) { vx[i] = 0.0f; vy[i] = 0.0f; vz[i] = 0.0f; }
+    }
+
+    void clear() {
+        for(int slot : slots.dense) { vx[slot] = 0.0f; vy[slot] = 0.0f; vz[slot] = 0.0f; }
+        slots.releaseAll();
+    }
+
+    // Index of a fresh slot; grows the pool when the free list is empty.
+    // -1 when a fixed pool is full.
+    int acquire() {
+        int i = slots.acquire();
+        if(i < 0) {
+            if constexpr(CAPACITY != 0) {
+                dropped++;
+            } else {
+                int grown = capacity() < 8 ? 16 : capacity() * 2;
+                slots.grow(grown);
+                resizeStorage(grown);
+                i = slots.acquire();
+            }
+        }
+        return i;
+    }
+
+    void place(int i, Vec3 p, Vec3 v, float l) {
+        px[i] = p.x; py[i] = p.y; pz[i] = p.z;
+        prevX[i] = p.x; prevY[i] = p.y; prevZ[i] = p.z;
+        vx[i] = v.x; vy[i] = v.y; vz[i] = v.z;
+        life[i] = l;
+    }
+
+    // Free slots keep integrating with the batch, so zero their velocity.
+    // Swap-removes from slots.dense; walk it back to front when killing.
+    void kill(int i) {
+        slots.release(i);
+        vx[i] = 0.0f; vy[i] = 0.0f; vz[i] = 0.0f;
+    }
+
+    Vec3 pos(int i) const { return Vec3(px[i], py[i], pz[i]); }
+
+    Vec3 renderPos(int i, float t) const {
+        return Vec3(prevX[i] + (px[i] - prevX[i]) * t, prevY[i] + (py[i] - prevY[i]) * t,
+                    prevZ[i] + (pz[i] - prevZ[i]) * t);
+    }
+
+    // Whole-array copy: cheaper than walking the live list at these sizes.
+    void savePrevious() {
+        memcpy(prevX.data(), px.data(), lanes() * sizeof(float));
+        memcpy(prevY.data(), py.data(), lanes() * sizeof(float));
+        memcpy(prevZ.data(), pz.data(), lanes() * sizeof(float));
+    }
+
+    void update(float dt) {
+        Simd::integrate(px.data(), py.data(), pz.data(), vx.data(), vy.data(), vz.data(),
+                        life.data(), lanes(), dt);
+        for(int k=slots.count()-1; k>=0; k--) {
+            int i = slots.dense[k];
+            if(life[i] <= 0.0f) kill(i);
+        }
+    }
+
+    // Slot bookkeeping plus every live slot's lanes. Free lanes come back
+    // zeroed, as after resize().
+    void save(ByteWriter& w) const {
+        slots.save(w);
+        for(int i : slots.dense) saveSlot(w, i);
+    }
+
+    // Storage is sized once for the stored capacity; vectors keep their
+    // allocation when it already fits. A fixed pool only takes its own
+    // CAPACITY.
+    bool load(ByteReader& r) {
+        if(!slots.load(r)) return false;
+        px.clear(); py.clear(); pz.clear();
+        vx.clear(); vy.clear(); vz.clear();
+        life.clear();
+        prevX.clear(); prevY.clear(); prevZ.clear();
+        resizeStorage(capacity());
+        for(int i : slots.dense) loadSlot(r, i);
+        return r.ok;
+    }
+
+protected:
+    virtual void saveSlot(ByteWriter& w, int i) const {
+        w.pod(px[i]); w.pod(py[i]); w.pod(pz[i]);
+        w.pod(vx[i]); w.pod(vy[i]); w.pod(vz[i]);
+        w.pod(life[i]);
+        w.pod(prevX[i]); w.pod(prevY[i]); w.pod(prevZ[i]);
+    }
+    virtual void loadSlot(ByteReader& r, int i) {
+        r.pod(px[i]); r.pod(py[i]); r.pod(pz[i]);
+        r.pod(vx[i]); r.pod(vy[i]); r.pod(vz[i]);
+        r.pod(life[i]);
+        r.pod(prevX[i]); r.pod(prevY[i]); r.pod(prevZ[i]);
+    }
+
+    // Hot arrays are padded to a multiple of 4 so kernels never need a tail.
+    // Existing slot data is preserved; new lanes start zeroed.
+    virtual void resizeStorage(int n) {
+        int padded = (n + 3) & ~3;
+        px.resize(padded, 0.0f); py.resize(padded, 0.0f); pz.resize(padded, 0.0f);
+        vx.resize(padded, 0.0f); vy.resize(padded, 0.0f); vz.resize(padded, 0.0f);
+        life.resize(padded, 0.0f);
+        prevX.resize(padded, 0.0f); prevY.resize(padded, 0.0f); prevZ.resize(padded, 0.0f);
+    }
+};
+
+typedef BasicKinematicPool<0> KinematicPool;
+#endif
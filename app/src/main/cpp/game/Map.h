@@ -2,77 +2,193 @@
 #define MAP_H
 #include "../core/MathUtils.h"
 #include "GameObject.h"
+#include <stdint.h>
+#include <atomic>
 #include <vector>
 
-class Map {
+// New on every layout change and unique across maps of every size, so
+// caches can tell layouts apart.
+inline unsigned nextMapRevision() {
+    static std::atomic<unsigned> counter(0);
+    return ++counter;
+}
+
+// Wall layout of SIZE x SIZE cells. Cell (i, j) is centred at (i *
+// CELL_SIZE - offset, j * CELL_SIZE - offset) on x/z. Walls are one bit per
+// cell: row i is a 64-bit word with bit j set, so a 50-cell layout is 400
+// bytes and a box test is one mask per overlapped row.
+template<int SIZE>
+class BasicMap {
 public:
-    int grid[GameConfig::MAP_SIZE][GameConfig::MAP_SIZE];
-    std::vector<Vec3> walls; 
+    static_assert(SIZE >= 8 && SIZE <= 64, "a wall row is one 64-bit word");
+    static constexpr int N = SIZE;
+    static constexpr float OFFSET = (N * GameConfig::CELL_SIZE) / 2.0f;
+    static constexpr float ORIGIN = -OFFSET - GameConfig::CELL_SIZE * 0.5f; // low edge of cell 0
+    static constexpr float SKIN = 1e-3f; // gap left between a swept box and the wall it stops at
+
+    uint64_t wallBits[N];
+    float cellMin[N + 1]; // cellMin[k]: low edge of cell k on either axis; cellMin[N] is the far edge
+    std::vector<Vec3> walls;
+    unsigned revision; // nextMapRevision() of the current layout
 
-    Map() {
-        generateDerb();
+    BasicMap() {
+        memset(wallBits, 0, sizeof(wallBits));
+        for(int k=0; k<=N; k++) cellMin[k] = ORIGIN + k * GameConfig::CELL_SIZE;
+        revision = 0;
     }
 
-    void generateDerb() {
-        walls.clear(); 
-        
-        for(int i=0; i<GameConfig::MAP_SIZE; i++) 
-            for(int j=0; j<GameConfig::MAP_SIZE; j++) grid[i][j] = 0;
+    bool isWall(int i, int j) const {
+        return i >= 0 && i < N && j >= 0 && j < N && ((wallBits[i] >> j) & 1);
+    }
+
+    void setWall(int i, int j) { wallBits[i] |= 1ull << j; }
+
+    void generateDerb(Random& rng) {
+        walls.clear();
+        revision = nextMapRevision();
+        memset(wallBits, 0, sizeof(wallBits));
 
-        for(int i=0; i<GameConfig::MAP_SIZE; i++) {
-            grid[i][0] = 1; grid[i][GameConfig::MAP_SIZE-1] = 1;
-            grid[0][i] = 1; grid[GameConfig::MAP_SIZE-1][i] = 1;
+        for(int i=0; i<N; i++) {
+            setWall(i, 0); setWall(i, N-1);
+            setWall(0, i); setWall(N-1, i);
         }
 
         for(int i=0; i<40; i++) {
-            int x = rand() % (GameConfig::MAP_SIZE-4) + 2;
-            int z = rand() % (GameConfig::MAP_SIZE-4) + 2;
-            for(int bx=0; bx<2; bx++) for(int bz=0; bz<2; bz++) grid[x+bx][z+bz] = 1;
+            int x = rng.range(N-4) + 2;
+            int z = rng.range(N-4) + 2;
+            for(int bx=0; bx<2; bx++) for(int bz=0; bz<2; bz++) setWall(x+bx, z+bz);
         }
-        
-        float offset = (GameConfig::MAP_SIZE * GameConfig::CELL_SIZE) / 2.0f;
-        for(int i=0; i<GameConfig::MAP_SIZE; i++) {
-            for(int j=0; j<GameConfig::MAP_SIZE; j++) {
-                if(grid[i][j] == 1) {
-                    float x = (i * GameConfig::CELL_SIZE) - offset;
-                    float z = (j * GameConfig::CELL_SIZE) - offset;
-                    walls.push_back(Vec3(x, 0, z));
-                }
+
+        rebuildWallList();
+    }
+
+    void save(ByteWriter& w) const { for(int i=0; i<N; i++) w.u64(wallBits[i]); }
+
+    // Replaces the layout without touching any rng, unlike generateDerb().
+    void load(ByteReader& r) {
+        for(int i=0; i<N; i++) wallBits[i] = r.u64();
+        revision = nextMapRevision();
+        rebuildWallList();
+    }
+
+    // Wall cell centres, for drawing.
+    void rebuildWallList() {
+        walls.clear();
+        for(int i=0; i<N; i++) {
+            for(int j=0; j<N; j++) {
+                if(isWall(i, j)) walls.push_back(Vec3(i * GameConfig::CELL_SIZE - OFFSET, 0, j * GameConfig::CELL_SIZE - OFFSET));
             }
         }
     }
 
-    // FIX: Using radius in collision
-    bool checkCollision(Vec3 pos, float radius) {
-        float offset = (GameConfig::MAP_SIZE * GameConfig::CELL_SIZE) / 2.0f;
-        int gx = (int)((pos.x + offset) / GameConfig::CELL_SIZE);
-        int gz = (int)((pos.z + offset) / GameConfig::CELL_SIZE);
-
-        // Check 3x3 grid around player
-        for(int i = gx-1; i <= gx+1; i++) {
-            for(int j = gz-1; j <= gz+1; j++) {
-                if(i >= 0 && i < GameConfig::MAP_SIZE && j >= 0 && j < GameConfig::MAP_SIZE) {
-                    if(grid[i][j] == 1) {
-                        float wx = (i * GameConfig::CELL_SIZE) - offset;
-                        float wz = (j * GameConfig::CELL_SIZE) - offset;
-                        
-                        // Wall AABB: Wall is Cell Size (4.0), half size is 2.0
-                        float halfWall = GameConfig::CELL_SIZE * 0.5f;
-                        
-                        // AABB vs AABB Collision (Player approximated as box of 'radius' size)
-                        // Player Box: [pos.x - radius, pos.x + radius]
-                        // Wall Box:   [wx - halfWall, wx + halfWall]
-                        
-                        bool xOverlap = (pos.x - radius < wx + halfWall) && (pos.x + radius > wx - halfWall);
-                        bool zOverlap = (pos.z - radius < wz + halfWall) && (pos.z + radius > wz - halfWall);
-                        
-                        if(xOverlap && zOverlap) return true;
-                    }
-                }
-            }
+    // True if the square of half-size `radius` around pos overlaps a wall
+    // cell (touching edges don't count).
+    bool checkCollision(Vec3 pos, float radius) const {
+        int i0 = firstCellAfter(pos.x - radius), i1 = lastCellBefore(pos.x + radius);
+        int j0 = firstCellAfter(pos.z - radius), j1 = lastCellBefore(pos.z + radius);
+        return anyWall(i0, i1, j0, j1);
+    }
+
+    // Moves the box of half-size `radius` from `from` by `delta` and returns
+    // the furthest legal position: x is swept first, then z, each stopping
+    // SKIN short of the first wall cell the box would enter, so blocked
+    // motion slides along walls and no step can pass through a cell. Cells
+    // the box already overlaps are ignored, so anything spawned inside a
+    // wall can still walk out.
+    Vec3 moveAndSlide(Vec3 from, Vec3 delta, float radius) const {
+        Vec3 p = from;
+        p.y += delta.y;
+        p.x = sweepAxis(p.x, delta.x, radius, firstCellAfter(p.z - radius), lastCellBefore(p.z + radius), true);
+        p.z = sweepAxis(p.z, delta.z, radius, firstCellAfter(p.x - radius), lastCellBefore(p.x + radius), false);
+        return p;
+    }
+
+    // True if no wall cell lies strictly between a and b on the XZ plane
+    // (the start cell is skipped). Amanatides-Woo grid traversal: step into
+    // whichever neighbouring cell the segment crosses into next, so every
+    // cell the segment touches is visited once, with no sampling gaps.
+    bool lineOfSight(Vec3 a, Vec3 b) const {
+        float fx = (a.x - ORIGIN) / GameConfig::CELL_SIZE, fz = (a.z - ORIGIN) / GameConfig::CELL_SIZE;
+        float tx = (b.x - ORIGIN) / GameConfig::CELL_SIZE, tz = (b.z - ORIGIN) / GameConfig::CELL_SIZE;
+        int i = (int)floorf(fx), j = (int)floorf(fz);
+        int iEnd = (int)floorf(tx), jEnd = (int)floorf(tz);
+        float dx = tx - fx, dz = tz - fz;
+
+        int stepI = dx > 0.0f ? 1 : -1, stepJ = dz > 0.0f ? 1 : -1;
+        float deltaX = dx != 0.0f ? fabsf(1.0f / dx) : 1e30f;
+        float deltaZ = dz != 0.0f ? fabsf(1.0f / dz) : 1e30f;
+        // An axis the segment doesn't move along is never crossed, even when
+        // the start sits exactly on one of its cell boundaries.
+        float maxX = dx > 0.0f ? (i + 1 - fx) * deltaX : dx < 0.0f ? (fx - i) * deltaX : 1e30f;
+        float maxZ = dz > 0.0f ? (j + 1 - fz) * deltaZ : dz < 0.0f ? (fz - j) * deltaZ : 1e30f;
+
+        for(int n = abs(iEnd - i) + abs(jEnd - j); n > 0; n--) {
+            if(maxX < maxZ) { i += stepI; maxX += deltaX; }
+            else            { j += stepJ; maxZ += deltaZ; }
+            if(isWall(i, j)) return false;
         }
+        return true;
+    }
+
+    // lineOfSight for n pairs; out[k] is 1 when from[k] sees to[k]. Returns
+    // how many are clear.
+    int lineOfSightBatch(const Vec3* from, const Vec3* to, int n, uint8_t* out) const {
+        int clear = 0;
+        for(int k=0; k<n; k++) {
+            out[k] = lineOfSight(from[k], to[k]) ? 1 : 0;
+            clear += out[k];
+        }
+        return clear;
+    }
+
+private:
+    // Cell whose span contains v (clamped to the grid). Used for a box's low
+    // edge: the first cell it can overlap.
+    static int firstCellAfter(float v) {
+        int k = (int)floorf((v - ORIGIN) / GameConfig::CELL_SIZE);
+        return k < 0 ? 0 : (k >= N ? N - 1 : k);
+    }
+
+    // Last cell whose low edge is strictly below v: the last cell a box with
+    // high edge v overlaps.
+    static int lastCellBefore(float v) {
+        int k = (int)ceilf((v - ORIGIN) / GameConfig::CELL_SIZE) - 1;
+        return k < 0 ? 0 : (k >= N ? N - 1 : k);
+    }
+
+    static uint64_t spanMask(int j0, int j1) {
+        if(j1 < j0) return 0;
+        uint64_t hi = (j1 >= 63) ? ~0ull : ((1ull << (j1 + 1)) - 1);
+        return hi & ~((1ull << j0) - 1);
+    }
+
+    bool anyWall(int i0, int i1, int j0, int j1) const {
+        uint64_t mask = spanMask(j0, j1);
+        for(int i=i0; i<=i1; i++) if(wallBits[i] & mask) return true;
         return false;
     }
+
+    // One axis of moveAndSlide. [c0, c1] is the box's cell range on the
+    // other axis. Scans the cells the leading edge enters, nearest first.
+    float sweepAxis(float v, float d, float radius, int c0, int c1, bool alongX) const {
+        if(d > 0.0f) {
+            float lead = v + radius, target = lead + d;
+            int k0 = (int)ceilf((lead - ORIGIN) / GameConfig::CELL_SIZE);
+            int k1 = lastCellBefore(target);
+            for(int k=(k0 < 0 ? 0 : k0); k<=k1; k++) {
+                if(alongX ? anyWall(k, k, c0, c1) : anyWall(c0, c1, k, k)) return cellMin[k] - radius - SKIN;
+            }
+        } else if(d < 0.0f) {
+            float lead = v - radius, target = lead + d;
+            int k0 = (int)floorf((lead - ORIGIN) / GameConfig::CELL_SIZE) - 1;
+            int k1 = firstCellAfter(target);
+            for(int k=(k0 >= N ? N - 1 : k0); k>=k1; k--) {
+                if(alongX ? anyWall(k, k, c0, c1) : anyWall(c0, c1, k, k)) return cellMin[k + 1] + radius + SKIN;
+            }
+        }
+        return v + d;
+    }
 };
-#endif
 
+typedef BasicMap<GameConfig::MAP_SIZE> Map;
+#endif
@@ -0,0 +1,67 @@
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "Map.h"
+
+// Generated layouts shared between worlds playing the same seed. A match's
+// layout is the first thing drawn from its freshly seeded rng, so a seed
+// determines both the map and the rng state after it; the cache keeps the
+// two together and a world that hits it skips generateDerb() yet continues
+// the exact same stream. Cached maps are never written again: World copies
+// before any change (see BasicWorld::ownMap). Safe to share between
+// threads. One cache holds layouts of one map size.
+template<class MapT>
+class BasicMapCache {
+public:
+    struct Entry {
+        std::shared_ptr<MapT> map;
+        Random rngAfter;
+    };
+
+    int hits, misses;
+
+    BasicMapCache() : hits(0), misses(0) {}
+
+    // `rng` must be freshly seeded with `seed`. Leaves it where
+    // generateDerb() would have and returns the shared layout.
+    std::shared_ptr<MapT> acquire(uint64_t seed, Random& rng) {
+        std::lock_guard<std::mutex> lock(m);
+        auto it = entries.find(seed);
+        if(it != entries.end()) {
+            hits++;
+            rng = it->second.rngAfter;
+            return it->second.map;
+        }
+        misses++;
+        Entry e;
+        e.map = std::make_shared<MapT>();
+        e.map->generateDerb(rng);
+        e.rngAfter = rng;
+        entries[seed] = e;
+        return e.map;
+    }
+
+    // Drops layouts no world holds any more.
+    void trim() {
+        std::lock_guard<std::mutex> lock(m);
+        for(auto it = entries.begin(); it != entries.end(); ) {
+            if(it->second.map.use_count() == 1) it = entries.erase(it);
+            else ++it;
+        }
+    }
+
+    int size() {
+        std::lock_guard<std::mutex> lock(m);
+        return (int)entries.size();
+    }
+
+private:
+    std::mutex m;
+    std::unordered_map<uint64_t, Entry> entries;
+};
+
+typedef BasicMapCache<Map> MapCache;
+#endif
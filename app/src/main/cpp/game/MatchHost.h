@@ -0,0 +1,116 @@
+#ifndef MATCH_HOST_H
+#define MATCH_HOST_H
+#include <functional>
+#include <vector>
+#include "World.h"
+#include "../core/JobSystem.h"
+
+// Totals over every match a MatchHost has finished. resultHash folds each
+// finished match's seed and final state hash in completion order.
+struct HostStats {
+    long long finished, wins, losses, timeouts, ticks;
+    uint64_t resultHash;
+};
+
+// Many independent headless matches in one process. Each World keeps its
+// bot AI on its own thread; the host spreads whole matches over a
+// JobSystem instead, one match per job, so idle workers steal from slow
+// ones. Every round a match runs at most sliceTicks ticks, which keeps a
+// long match from holding up a round, and at most maxTicks in total, after
+// which it counts as a timeout. Between rounds the calling thread tallies
+// finished matches and restarts their slots in slot order, so which seed
+// lands where, and every result, is the same for any thread count.
+//
+// With a MapCache every world playing the same seed shares one layout.
+// Mode is the hosted worlds' mode (see WorldMode.h).
+template<class Mode>
+class BasicMatchHost {
+public:
+    typedef BasicWorld<Mode> WorldType;
+
+    std::vector<WorldType*> worlds; // one per slot
+    std::vector<int> matchTicks;  // ticks the slot's current match has run
+    std::vector<uint8_t> running; // slot holds a match that isn't over
+    int sliceTicks;
+    int maxTicks;
+    float dt;
+    uint64_t firstSeed;
+    int seedCycle;       // > 0: seeds repeat every seedCycle matches
+    long long toStart;   // matches not yet started; -1 keeps restarting forever
+    std::function<void(WorldType&)> input; // called before every tick; empty = no input
+    HostStats stats;
+
+    BasicMatchHost(int slots, long long matches, uint64_t seed, int bots,
+                   typename WorldType::MapCacheType* maps = NULL)
+        : sliceTicks(60), maxTicks(3600), dt(1.0f / GameConfig::SIM_HZ), firstSeed(seed), seedCycle(0),
+          toStart(matches), started(0) {
+        memset(&stats, 0, sizeof(stats));
+        stats.resultHash = 0xCBF29CE484222325ull;
+        for(int s=0; s<slots; s++) {
+            WorldType* w = new WorldType(seed, maps);
+            w->botCount = bots;
+            worlds.push_back(w);
+            matchTicks.push_back(0);
+            running.push_back(0);
+        }
+    }
+
+    ~BasicMatchHost() { for(WorldType* w : worlds) delete w; }
+
+    int slots() const { return (int)worlds.size(); }
+
+    // Fills idle slots, runs one slice of every match, then tallies the
+    // ones that ended. Returns false once nothing is left to run.
+    bool round(JobSystem& jobs) {
+        for(int s=0; s<slots(); s++) if(!running[s]) start(s);
+        jobs.parallelFor(slots(), 1, [this](int begin, int end) {
+            for(int s=begin; s<end; s++) runSlice(s);
+        });
+        bool any = toStart != 0;
+        for(int s=0; s<slots(); s++) {
+            if(running[s] && (worlds[s]->gameState != 0 || matchTicks[s] >= maxTicks)) finish(s);
+            any |= running[s] != 0;
+        }
+        return any;
+    }
+
+private:
+    long long started;
+
+    void start(int s) {
+        if(toStart == 0) return;
+        if(toStart > 0) toStart--;
+        uint64_t n = seedCycle > 0 ? (uint64_t)(started % seedCycle) : (uint64_t)started;
+        started++;
+        worlds[s]->reset(firstSeed + n);
+        matchTicks[s] = 0;
+        running[s] = 1;
+    }
+
+    void runSlice(int s) {
+        if(!running[s]) return;
+        WorldType& w = *worlds[s];
+        for(int t=0; t<sliceTicks && w.gameState == 0 && matchTicks[s] < maxTicks; t++) {
+            if(input) input(w);
+            w.update(dt);
+            matchTicks[s]++;
+        }
+    }
+
+    void finish(int s) {
+        const WorldType& w = *worlds[s];
+        running[s] = 0;
+        stats.finished++;
+        stats.ticks += matchTicks[s];
+        if(w.gameState == 1) stats.wins++;
+        else if(w.gameState == 2) stats.losses++;
+        else stats.timeouts++;
+        uint64_t parts[2] = { w.seed, w.stateHash() };
+        for(uint64_t v : parts) {
+            for(int k=0; k<8; k++) { stats.resultHash ^= (v >> (8 * k)) & 0xFF; stats.resultHash *= 0x100000001B3ull; }
+        }
+    }
+};
+
+typedef BasicMatchHost<StandardMode> MatchHost;
+#endif
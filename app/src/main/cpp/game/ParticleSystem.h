@@ -0,0 +1,236 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+#include <stdint.h>
+#include <vector>
+#include "GameObject.h"
+#include "../core/InlineVector.h"
+#include "../core/JobSystem.h"
+#include "../core/SimdKernels.h"
+
+// Four evenly spaced keys over a particle's life, from spawn (t = 0) to
+// expiry (t = 1), linear in between.
+struct LifeCurve {
+    float k[4];
+
+    float at(float t) const {
+        if(t <= 0.0f) return k[0];
+        if(t >= 1.0f) return k[3];
+        float f = t * 3.0f;
+        int i = (int)f;
+        return k[i] + (k[i + 1] - k[i]) * (f - i);
+    }
+};
+
+enum ParticleEmitterId : uint8_t { EMIT_HIT, EMIT_KILL, EMIT_BOSS_KILL, EMIT_COUNT };
+
+// What an emitter's particles look like over their life. Motion is set
+// per particle at spawn.
+struct ParticleEmitter {
+    float life;  // seconds
+    Vec3 color;
+    LifeCurve alpha;
+    LifeCurve size;
+};
+
+inline const ParticleEmitter& particleEmitter(int id) {
+    static const ParticleEmitter emitters[EMIT_COUNT] = {
+        { 0.8f, Vec3(1.0f, 0.0f, 0.0f), {{ 0.8f, 0.5333f, 0.2667f, 0.0f }}, {{ 0.3f, 0.3f, 0.3f, 0.3f }} },   // EMIT_HIT
+        { 0.8f, Vec3(1.0f, 0.0f, 0.0f), {{ 0.8f, 0.5333f, 0.2667f, 0.0f }}, {{ 0.35f, 0.3f, 0.25f, 0.15f }} }, // EMIT_KILL
+        { 0.8f, Vec3(0.5f, 0.0f, 0.0f), {{ 1.0f, 0.8f, 0.4f, 0.0f }}, {{ 0.3f, 0.5f, 0.45f, 0.2f }} },         // EMIT_BOSS_KILL
+    };
+    return emitters[id];
+}
+
+// Cosmetic particles in a ring buffer. Spawns append at the tail and a
+// burst of n is one reservation of n consecutive lanes; expired particles
+// leave from the head, so there is no free list and no per-particle
+// bookkeeping. The live range is one span, or two when it wraps, and the
+// integrator runs over just that range in lane-aligned chunks on a
+// JobSystem. A particle that expires behind a longer-lived one keeps its
+// lane until the head reaches it; isActive() and the renderer skip it. With
+// CAPACITY 0 the ring doubles when a reservation doesn't fit, so nothing is
+// dropped until it reaches MAX_CAPACITY; past that the oldest particles
+// make room. A fixed ring is CAPACITY lanes held inline (a power of two)
+// and makes room the same way from the start.
+template<int CAPACITY>
+class BasicParticleSystem {
+public:
+    static_assert(CAPACITY == 0 || (CAPACITY >= 16 && (CAPACITY & (CAPACITY - 1)) == 0),
+                  "a fixed ring is a power of two of at least 16 lanes");
+    static constexpr int MAX_CAPACITY = 1 << 20; // lanes; also the largest ring a snapshot may hold
+
+    PoolVector<float, CAPACITY> px, py, pz;
+    PoolVector<float, CAPACITY> vx, vy, vz;
+    PoolVector<float, CAPACITY> life;                // seconds left; <= 0 is expired
+    PoolVector<float, CAPACITY> prevX, prevY, prevZ; // positions at the start of the last fixed tick
+    PoolVector<uint8_t, CAPACITY> emitter;           // ParticleEmitterId per lane
+    uint32_t head, tail;                             // ring positions; lane = position & mask
+    int grain;                                       // lanes per update job
+    int dropped;                                     // particles overwritten to make room
+
+    BasicParticleSystem() : head(0), tail(0), grain(1024), dropped(0), mask(0) {
+        if(CAPACITY) resizeStorage(CAPACITY);
+    }
+
+    int capacity() const { return CAPACITY ? CAPACITY : (int)px.size(); }
+    int count() const { return (int)(tail - head); } // reserved lanes, expired stragglers included
+    int lane(uint32_t pos) const { return (int)(pos & (CAPACITY ? CAPACITY - 1 : mask)); }
+    bool isActive(int i) const { return life[i] > 0.0f; }
+
+    // Drop everything and size the ring for at least n lanes; a fixed ring
+    // stays at CAPACITY.
+    void resize(int n) {
+        int cap = 16;
+        while(cap < n) cap *= 2;
+        head = tail = 0;
+        resizeStorage(CAPACITY ? CAPACITY : cap);
+    }
+
+    void clear() { head = tail = 0; }
+
+    // Position of the first of n consecutive lanes, n <= the largest ring
+    // (MAX_CAPACITY, or CAPACITY when fixed); grows the ring first when they
+    // don't fit.
+    uint32_t reserve(int n) {
+        const int limit = CAPACITY ? CAPACITY : MAX_CAPACITY;
+        if(count() + n > limit) {
+            dropped += count() + n - limit;
+            head = tail + n - limit;
+        }
+        if constexpr(CAPACITY == 0) {
+            if(count() + n > capacity()) {
+                int cap = capacity() < 16 ? 16 : capacity();
+                while(cap < count() + n) cap *= 2;
+                grow(cap);
+            }
+        }
+        uint32_t first = tail;
+        tail += n;
+        return first;
+    }
+
+    void place(int i, Vec3 p, Vec3 v, int id) {
+        px[i] = p.x; py[i] = p.y; pz[i] = p.z;
+        prevX[i] = p.x; prevY[i] = p.y; prevZ[i] = p.z;
+        vx[i] = v.x; vy[i] = v.y; vz[i] = v.z;
+        life[i] = particleEmitter(id).life;
+        emitter[i] = (uint8_t)id;
+    }
+
+    void spawn(Vec3 p, Vec3 v, int id) { place(lane(reserve(1)), p, v, id); }
+
+    Vec3 renderPos(int i, float t) const {
+        return Vec3(prevX[i] + (px[i] - prevX[i]) * t, prevY[i] + (py[i] - prevY[i]) * t,
+                    prevZ[i] + (pz[i] - prevZ[i]) * t);
+    }
+
+    // Fraction of the particle's life already spent.
+    float ageOf(int i) const {
+        const ParticleEmitter& e = particleEmitter(emitter[i]);
+        return 1.0f - life[i] / e.life;
+    }
+    float alphaOf(int i) const { return particleEmitter(emitter[i]).alpha.at(ageOf(i)); }
+    float sizeOf(int i) const { return particleEmitter(emitter[i]).size.at(ageOf(i)); }
+    Vec3 colorOf(int i) const { return particleEmitter(emitter[i]).color; }
+
+    // Whole-array copy: cheaper than walking the live range at these sizes.
+    void savePrevious() {
+        memcpy(prevX.data(), px.data(), capacity() * sizeof(float));
+        memcpy(prevY.data(), py.data(), capacity() * sizeof(float));
+        memcpy(prevZ.data(), pz.data(), capacity() * sizeof(float));
+    }
+
+    // Integrates the live range, then retires the expired run at the head.
+    // The range is cut into groups of 4 lanes for the kernel; lanes the
+    // rounding pulls in lie outside it, so integrating them is harmless.
+    // `jobs` may be NULL; rings under `grain` lanes run inline either way.
+    void update(float dt, JobSystem* jobs = NULL) {
+        if(head == tail) return;
+        uint32_t lo = head & ~3u;
+        int groups = (int)((((tail + 3) & ~3u) - lo) / 4);
+        if(groups > capacity() / 4) groups = capacity() / 4;
+        auto run = [this, lo, dt](int g0, int g1) {
+            int begin = lane(lo + g0 * 4), n = (g1 - g0) * 4;
+            int first = n < capacity() - begin ? n : capacity() - begin;
+            integrate(begin, first, dt);
+            if(first < n) integrate(0, n - first, dt);
+        };
+        if(jobs) jobs->parallelFor(groups, grain / 4, run);
+        else run(0, groups);
+        while(head != tail && life[lane(head)] <= 0.0f) head++;
+    }
+
+    // Live range in ring order, relinked from lane 0 on load.
+    void save(ByteWriter& w) const {
+        w.varint(capacity());
+        w.varint(count());
+        for(uint32_t p=head; p!=tail; p++) {
+            int i = lane(p);
+            w.pod(px[i]); w.pod(py[i]); w.pod(pz[i]);
+            w.pod(vx[i]); w.pod(vy[i]); w.pod(vz[i]);
+            w.pod(life[i]);
+            w.pod(prevX[i]); w.pod(prevY[i]); w.pod(prevZ[i]);
+            w.u8(emitter[i]);
+        }
+    }
+
+    // False for a capacity reserve() can't have produced (for a fixed ring,
+    // anything but CAPACITY), a count the stream can't hold (the ring is
+    // then untouched) or a bad lane (the ring is left empty).
+    bool load(ByteReader& r) {
+        uint64_t cap = r.varint(), n = r.varint();
+        if(!r.ok || cap < 16 || cap > (uint64_t)MAX_CAPACITY || (cap & (cap - 1)) != 0 || n > cap ||
+           n * 41 > r.remaining()) return false;
+        if(CAPACITY && cap != (uint64_t)CAPACITY) return false;
+        head = tail = 0;
+        resizeStorage((int)cap);
+        for(size_t i=0; i<n; i++) {
+            r.pod(px[i]); r.pod(py[i]); r.pod(pz[i]);
+            r.pod(vx[i]); r.pod(vy[i]); r.pod(vz[i]);
+            r.pod(life[i]);
+            r.pod(prevX[i]); r.pod(prevY[i]); r.pod(prevZ[i]);
+            emitter[i] = r.u8();
+            if(emitter[i] >= EMIT_COUNT) return false;
+        }
+        tail = (uint32_t)n;
+        return r.ok;
+    }
+
+private:
+    uint32_t mask;
+
+    void integrate(int i, int n, float dt) {
+        Simd::integrate(&px[i], &py[i], &pz[i], &vx[i], &vy[i], &vz[i], &life[i], n, dt);
+    }
+
+    // Relinks the live range from lane 0 into a ring of `cap` lanes.
+    void grow(int cap) {
+        int n = count();
+        std::vector<float>* lanes[] = { &px, &py, &pz, &vx, &vy, &vz, &life, &prevX, &prevY, &prevZ };
+        std::vector<float> moved(cap, 0.0f);
+        for(std::vector<float>* a : lanes) {
+            for(int k=0; k<n; k++) moved[k] = (*a)[lane(head + k)];
+            a->swap(moved);
+            moved.assign(cap, 0.0f);
+        }
+        std::vector<uint8_t> ids(cap, 0);
+        for(int k=0; k<n; k++) ids[k] = emitter[lane(head + k)];
+        emitter.swap(ids);
+        mask = (uint32_t)cap - 1;
+        head = 0;
+        tail = (uint32_t)n;
+    }
+
+    // `n` is a power of two of at least 16. Lanes start zeroed.
+    void resizeStorage(int n) {
+        px.assign(n, 0.0f); py.assign(n, 0.0f); pz.assign(n, 0.0f);
+        vx.assign(n, 0.0f); vy.assign(n, 0.0f); vz.assign(n, 0.0f);
+        life.assign(n, 0.0f);
+        prevX.assign(n, 0.0f); prevY.assign(n, 0.0f); prevZ.assign(n, 0.0f);
+        emitter.assign(n, 0);
+        mask = (uint32_t)n - 1;
+    }
+};
+
+typedef BasicParticleSystem<0> ParticleSystem;
+#endif
@@ -14,6 +14,7 @@ public:
 
     float baseSpeed, baseDmg, baseMaxHp, baseDashCd;
     float currentSpeed; 
+    Vec3 moveDir;
 
     Player() {
         type = EntityType::PLAYER;
@@ -25,17 +26,37 @@ public:
     }
 
     void reset() {
-        isDead = false; pos = Vec3(0,0,0); isActive = true;
+        isDead = false; pos = Vec3(0,0,0); prevPos = pos; isActive = true;
         dashActive = false; dashTimer = 0; dashCooldown = 0;
         ultActive = false; ultTimer = 0; ultCooldown = 0;
         
         weaponType = WeaponType::PISTOL; 
-        skinId = 0; animTimer = 0;
+        skinId = 0; animTimer = 0; fireTimer = 0;
+        moveDir = Vec3(0,0,0);
         scaleV = Vec3(1,1,1);
         
         applySkin(); 
     }
 
+    void save(ByteWriter& w) const override {
+        Entity::save(w);
+        w.u8(dashActive); w.pod(dashTimer); w.pod(dashCooldown);
+        w.u8(ultActive); w.pod(ultTimer); w.pod(ultCooldown);
+        aura.save(w);
+        w.pod(animTimer);
+        w.pod(baseSpeed); w.pod(baseDmg); w.pod(baseMaxHp); w.pod(baseDashCd);
+        w.pod(currentSpeed); w.pod(moveDir);
+    }
+    void load(ByteReader& r) override {
+        Entity::load(r);
+        dashActive = r.u8() != 0; r.pod(dashTimer); r.pod(dashCooldown);
+        ultActive = r.u8() != 0; r.pod(ultTimer); r.pod(ultCooldown);
+        aura.load(r);
+        r.pod(animTimer);
+        r.pod(baseSpeed); r.pod(baseDmg); r.pod(baseMaxHp); r.pod(baseDashCd);
+        r.pod(currentSpeed); r.pod(moveDir);
+    }
+
     void applySkin() {
         speed = baseSpeed;
         weaponDmg = baseDmg;
@@ -77,6 +98,7 @@ public:
             ultCooldown = GameConfig::ULT_COOLDOWN;
             hp = fmin(hp + 30.0f, maxHp); 
             aura.isActive = true;
+            aura.pos = pos; aura.prevPos = pos;
             aura.color = Vec3(0, 1, 1); 
             scaleV = Vec3(1.5f, 1.5f, 1.5f); 
         }
@@ -139,10 +161,6 @@ public:
         
         fireTimer = fmax(0.0f, fireTimer - dt);
     }
-    
-    void drawAura(Shader* s, Mat4& vp) {
-        if(aura.isActive) aura.draw(s, vp);
-    }
 };
 #endif
 
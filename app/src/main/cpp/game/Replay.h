@@ -0,0 +1,239 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+#include <chrono>
+#include <string>
+#include "World.h"
+#include "../core/ByteStream.h"
+
+// Input recordings. GameEngine::input() and step() are the only inputs to a
+// match, so its seed plus what those were fed replays it exactly. The
+// stick is quantized to 1/STICK_SCALE and frame times to whole
+// microseconds before the world sees them, live or replayed, so a replay
+// feeds bit-identical floats.
+//
+// File layout (little endian):
+//   "DRIN" u8 version u64 seed, then varints simHz botCount hashInterval
+//   steps ticks, the mode name (varint length, bytes) and a u8 of
+//   world flags (bit 0: AI level of detail on). Then per step a flags
+//   byte (bit 0/1/2: stick x / stick y / frame time changed, bit 3/4/5:
+//   fire / dash / ult), a zigzag varint delta for each changed value, and
+//   a u32 state hash after every hashInterval-th tick that step ran.
+class InputRecorder : public TickListener {
+public:
+    static constexpr int STICK_SCALE = 4096;
+    static constexpr uint8_t VERSION = 2;
+
+    static int quantizeStick(float v) {
+        if(v > 1.0f) v = 1.0f;
+        if(v < -1.0f) v = -1.0f;
+        return (int)lroundf(v * STICK_SCALE);
+    }
+    static float stickValue(int q) { return q / (float)STICK_SCALE; }
+
+    static uint32_t quantizeDt(float dt) {
+        if(!(dt > 0.0f)) return 0;
+        if(dt > 1.0f) dt = 1.0f;
+        return (uint32_t)lroundf(dt * 1e6f);
+    }
+    static float dtValue(uint32_t us) { return us * 1e-6f; }
+
+    static uint32_t foldHash(uint64_t h) { return (uint32_t)(h ^ (h >> 32)); }
+
+    uint64_t seed;
+    int simHz, botCount, hashInterval;
+    long long steps, ticks;
+    std::string mode;
+    bool aiLod;
+    ByteWriter body;
+
+    explicit InputRecorder(int hashEvery = 1) : hashInterval(hashEvery < 1 ? 1 : hashEvery) { clear(); }
+
+    // Starts a recording of `world` (any BasicWorld), which must be at the
+    // start of its match.
+    template<class W>
+    void begin(const W& world) {
+        clear();
+        seed = world.seed;
+        simHz = world.simRate();
+        botCount = world.botCount;
+        mode = W::Mode::NAME;
+        aiLod = world.entities->aiLod;
+    }
+
+    // Same latching as World::input: the stick keeps the last value, buttons
+    // stay down until the next step.
+    void input(int stickX, int stickY, bool fire, bool dash, bool ult) {
+        x = stickX; y = stickY;
+        buttons |= (fire ? 8 : 0) | (dash ? 16 : 0) | (ult ? 32 : 0);
+    }
+
+    void step(uint32_t dtMicros) {
+        uint8_t flags = buttons;
+        if(x != lastX) flags |= 1;
+        if(y != lastY) flags |= 2;
+        if(dtMicros != lastDt) flags |= 4;
+        body.u8(flags);
+        if(flags & 1) body.svarint(x - lastX);
+        if(flags & 2) body.svarint(y - lastY);
+        if(flags & 4) body.svarint((int64_t)dtMicros - lastDt);
+        lastX = x; lastY = y; lastDt = dtMicros;
+        buttons = 0;
+        steps++;
+    }
+
+    void afterTick(uint64_t stateHash) override {
+        ticks++;
+        if(ticks % hashInterval == 0) body.u32(foldHash(stateHash));
+    }
+
+    void write(ByteWriter& out) const {
+        out.raw("DRIN", 4);
+        out.u8(VERSION);
+        out.u64(seed);
+        out.varint(simHz); out.varint(botCount); out.varint(hashInterval);
+        out.varint(steps); out.varint(ticks);
+        out.varint(mode.size());
+        out.raw(mode.data(), mode.size());
+        out.u8(aiLod ? 1 : 0);
+        out.raw(body.bytes.data(), body.bytes.size());
+    }
+
+    bool save(const char* path) const {
+        ByteWriter out;
+        write(out);
+        return out.save(path);
+    }
+
+private:
+    int x, y, lastX, lastY;
+    uint32_t lastDt;
+    uint8_t buttons;
+
+    void clear() {
+        seed = 0; simHz = GameConfig::SIM_HZ; botCount = GameConfig::BOT_COUNT;
+        mode = StandardMode::NAME;
+        aiLod = true;
+        steps = 0; ticks = 0;
+        body.bytes.clear();
+        x = y = lastX = lastY = 0;
+        lastDt = 0;
+        buttons = 0;
+    }
+};
+
+struct ReplayResult {
+    long long steps, ticks;
+    long long divergedAt; // first tick whose hash differs, -1 if none
+    double seconds;
+    uint64_t finalHash;
+};
+
+// Plays a recording back into a world as fast as it will run: no frame
+// pacing and no rendering, just input() and advance() per recorded step.
+// The world must be a BasicWorld of the recorded mode; withWorldMode(mode)
+// picks the type.
+class Replay : public TickListener {
+public:
+    uint64_t seed;
+    int simHz, botCount, hashInterval;
+    long long steps, ticks;
+    std::string mode;
+    bool aiLod;
+    std::vector<uint8_t> data;
+    size_t bodyOffset;
+    const char* error; // why load()/parse() failed
+
+    Replay() : seed(0), simHz(0), botCount(0), hashInterval(1), steps(0), ticks(0), mode(StandardMode::NAME), aiLod(true), bodyOffset(0), error(NULL),
+               reader(NULL), tick(0), diverged(-1) {}
+
+    bool load(const char* path) {
+        if(!readFile(path, data)) { error = "cannot read file"; return false; }
+        return parse();
+    }
+
+    bool parse() {
+        ByteReader r(data.data(), data.size());
+        char magic[4];
+        if(!r.raw(magic, 4) || memcmp(magic, "DRIN", 4) != 0) { error = "not an input recording"; return false; }
+        uint8_t version = r.u8();
+        if(version < 1 || version > InputRecorder::VERSION) { error = "unsupported version"; return false; }
+        seed = r.u64();
+        simHz = (int)r.varint(); botCount = (int)r.varint(); hashInterval = (int)r.varint();
+        steps = (long long)r.varint(); ticks = (long long)r.varint();
+        // Version 1 predates modes and the LOD switch: its matches were all
+        // standard, with level of detail on.
+        char name[32] = "standard";
+        aiLod = true;
+        if(version >= 2) {
+            size_t length = r.varint();
+            if(length >= sizeof(name) || !r.raw(name, length)) { error = "truncated header"; return false; }
+            name[length] = 0;
+            uint8_t flags = r.u8();
+            if(flags > 1) { error = "unknown world flags"; return false; }
+            aiLod = (flags & 1) != 0;
+        }
+        if(!r.ok || simHz <= 0 || hashInterval <= 0) { error = "truncated header"; return false; }
+        if(simHz < GameConfig::MIN_SIM_HZ || simHz > GameConfig::MAX_SIM_HZ) { error = "sim rate out of range"; return false; }
+        if(!withWorldMode(name, [](auto) {})) { error = "unknown world mode"; return false; }
+        mode = name;
+        bodyOffset = data.size() - r.remaining();
+        return true;
+    }
+
+    // Resets `world` to the recorded match, with the recorded AI level of
+    // detail, and replays every step, stopping at the first tick whose
+    // hash differs from the recording. A world of another mode or too few
+    // bot slots diverges at tick 0.
+    template<class W>
+    ReplayResult run(W& world) {
+        ReplayResult res = { 0, 0, 0, 0.0, 0 };
+        if(mode != W::Mode::NAME || botCount > W::MAX_BOTS) return res;
+        world.botCount = botCount;
+        world.entities->aiLod = aiLod;
+        world.setSimRate(simHz);
+        world.reset(seed);
+        TickListener* previous = world.tickListener;
+        world.tickListener = this;
+
+        ByteReader r(data.data() + bodyOffset, data.size() - bodyOffset);
+        reader = &r;
+        tick = 0;
+        diverged = -1;
+        long long s = 0;
+        int x = 0, y = 0;
+        int64_t dt = 0;
+        auto start = std::chrono::steady_clock::now();
+        for(; s<steps && diverged < 0; s++) {
+            uint8_t flags = r.u8();
+            if(flags & 1) x += (int)r.svarint();
+            if(flags & 2) y += (int)r.svarint();
+            if(flags & 4) dt += r.svarint();
+            if(!r.ok) { diverged = tick; break; }
+            world.input(InputRecorder::stickValue(x), InputRecorder::stickValue(y), (flags & 8) != 0, (flags & 16) != 0, (flags & 32) != 0);
+            world.advance(InputRecorder::dtValue((uint32_t)dt));
+        }
+        if(diverged < 0 && tick != ticks) diverged = tick;
+
+        res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        res.steps = s;
+        res.ticks = tick;
+        res.divergedAt = diverged;
+        res.finalHash = world.stateHash();
+        world.tickListener = previous;
+        reader = NULL;
+        return res;
+    }
+
+    void afterTick(uint64_t stateHash) override {
+        tick++;
+        if(tick % hashInterval != 0) return;
+        uint32_t want = reader->u32();
+        if(diverged < 0 && (!reader->ok || want != InputRecorder::foldHash(stateHash))) diverged = tick;
+    }
+
+private:
+    ByteReader* reader;
+    long long tick;
+    long long diverged;
+};
+#endif
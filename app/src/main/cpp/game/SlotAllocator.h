@@ -0,0 +1,159 @@
+#ifndef SLOT_ALLOCATOR_H
+#define SLOT_ALLOCATOR_H
+#include <stdint.h>
+#include <vector>
+#include "../core/ByteStream.h"
+#include "../core/InlineVector.h"
+
+// Reference to a pool slot that survives pool growth and notices reuse: the
+// generation is bumped every time the slot is released.
+struct Handle {
+    int32_t index;
+    uint32_t generation;
+
+    static const int32_t NONE = -1;
+    static const int32_t PLAYER = -2; // the single Player, not a pool slot
+
+    Handle() : index(NONE), generation(0) {}
+    Handle(int32_t i, uint32_t g) : index(i), generation(g) {}
+
+    static Handle none() { return Handle(); }
+    static Handle player() { return Handle(PLAYER, 0); }
+
+    bool isNone() const { return index == NONE; }
+    bool isPlayer() const { return index == PLAYER; }
+    bool operator==(const Handle& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const Handle& o) const { return !(*this == o); }
+
+    void save(ByteWriter& w) const { w.svarint(index); w.varint(generation); }
+    void load(ByteReader& r) { index = (int32_t)r.svarint(); generation = (uint32_t)r.varint(); }
+};
+
+// Slot bookkeeping shared by the entity pools: O(1) acquire/release through
+// a LIFO free list, a dense list of live slots for iteration, and
+// per-slot generations for handles. The owner keeps the actual slot data
+// and resizes it whenever grow() is called. CAPACITY 0 grows; anything
+// else is exactly that many slots in inline storage (see WorldMode.h),
+// which never grow.
+template<int CAPACITY>
+class BasicSlotAllocator {
+public:
+    PoolVector<int, CAPACITY> freeList;     // top of stack is the next slot handed out
+    PoolVector<int, CAPACITY> dense;        // live slots
+    PoolVector<int, CAPACITY> denseIndex;   // slot -> position in dense, -1 when free
+    PoolVector<uint32_t, CAPACITY> generation;
+
+    BasicSlotAllocator() { reset(CAPACITY); }
+
+    int capacity() const { return (int)denseIndex.size(); }
+    int count() const { return (int)dense.size(); }
+    bool isLive(int slot) const { return denseIndex[slot] >= 0; }
+
+    // Free every slot. Slots are handed out lowest index first.
+    void reset(int n) {
+        freeList.clear(); dense.clear();
+        denseIndex.assign(n, -1);
+        generation.resize(n, 0);
+        for(int i=n-1; i>=0; i--) freeList.push_back(i);
+    }
+
+    // Release all live slots, bumping their generations, keeping capacity.
+    void releaseAll() {
+        while(!dense.empty()) release(dense.back());
+        reset(capacity());
+    }
+
+    void grow(int newCapacity) {
+        static_assert(CAPACITY == 0, "fixed pools don't grow");
+        int old = capacity();
+        if(newCapacity <= old) return;
+        denseIndex.resize(newCapacity, -1);
+        generation.resize(newCapacity, 0);
+        // Keep handing out low indices first: new slots go under the old free ones.
+        freeList.insert(freeList.begin(), newCapacity - old, 0);
+        for(int i=0; i<newCapacity-old; i++) freeList[i] = newCapacity - 1 - i;
+    }
+
+    // Returns -1 when full; the owner decides whether to grow.
+    int acquire() {
+        if(freeList.empty()) return -1;
+        int slot = freeList.back();
+        freeList.pop_back();
+        denseIndex[slot] = (int)dense.size();
+        dense.push_back(slot);
+        return slot;
+    }
+
+    // Swap-removes from the dense list, so release while walking dense
+    // back to front.
+    void release(int slot) {
+        int at = denseIndex[slot];
+        if(at < 0) return;
+        int last = dense.back();
+        dense[at] = last;
+        denseIndex[last] = at;
+        dense.pop_back();
+        denseIndex[slot] = -1;
+        generation[slot]++;
+        freeList.push_back(slot);
+    }
+
+    // Exact state, free-list order included, so a restored pool hands out
+    // the same slots in the same order.
+    void save(ByteWriter& w) const {
+        w.varint(capacity());
+        w.varint(dense.size());
+        for(int s : dense) w.varint(s);
+        w.varint(freeList.size());
+        for(int s : freeList) w.varint(s);
+        for(uint32_t g : generation) w.varint(g);
+    }
+
+    // False if the slot lists don't describe `capacity` slots exactly once,
+    // or a fixed allocator's capacity is not CAPACITY. The allocator is
+    // then left empty: no slots, or CAPACITY free ones when fixed.
+    bool load(ByteReader& r) {
+        if(loadSlots(r) && r.ok) return true;
+        reset(CAPACITY);
+        return false;
+    }
+
+    Handle handleOf(int slot) const { return Handle(slot, generation[slot]); }
+
+    bool isValid(Handle h) const {
+        return h.index >= 0 && h.index < capacity() && generation[h.index] == h.generation && isLive(h.index);
+    }
+
+private:
+    bool loadSlots(ByteReader& r) {
+        size_t n = r.varint();
+        if(!r.ok || n > r.remaining()) return false; // every slot stores at least a generation byte
+        if(CAPACITY != 0 && n != (size_t)CAPACITY) return false;
+        denseIndex.assign(n, -1);
+        generation.resize(n);
+        size_t live = r.varint();
+        if(live > n) return false;
+        dense.resize(live);
+        for(size_t k=0; k<live; k++) {
+            size_t s = r.varint();
+            if(s >= n || denseIndex[s] >= 0) return false;
+            dense[k] = (int)s;
+            denseIndex[s] = (int)k;
+        }
+        size_t free = r.varint();
+        if(live + free != n) return false;
+        freeList.resize(free);
+        // Free slots are marked -2 while reading, so a repeat is caught.
+        for(int& s : freeList) {
+            s = (int)r.varint();
+            if(s < 0 || (size_t)s >= n || denseIndex[s] != -1) return false;
+            denseIndex[s] = -2;
+        }
+        for(int s : freeList) denseIndex[s] = -1;
+        for(uint32_t& g : generation) g = (uint32_t)r.varint();
+        return r.ok;
+    }
+};
+
+typedef BasicSlotAllocator<0> SlotAllocator;
+#endif
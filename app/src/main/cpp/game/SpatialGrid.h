@@ -0,0 +1,100 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+#include <vector>
+#include "GameObject.h"
+#include "../core/InlineVector.h"
+
+// Uniform XZ grid over a MAP_CELLS x MAP_CELLS map, aligned with its cells
+// and rebuilt once per tick. Each cell is an intrusive singly linked list
+// of item ids. Items keep the position they had at insert time, so every
+// query in a tick sees the same snapshot regardless of who has moved
+// since. ITEMS is the id range of a fixed pool, whose item arrays are held
+// inline, or 0 for one that grows. Cell heads are sized once, at
+// construction.
+template<int MAP_CELLS, int ITEMS>
+class BasicSpatialGrid {
+public:
+    float cellSize;
+    float origin;  // world coordinate of the grid's low corner on both axes
+    int dim;       // cells per side
+
+    std::vector<int> cellHead;        // first id in each cell, -1 when empty
+    PoolVector<int, ITEMS> nextItem;  // next id in the same cell, -1 at the end
+    PoolVector<float, ITEMS> itemX, itemZ;
+
+    BasicSpatialGrid(int mapCellsPerCell = 1) {
+        cellSize = GameConfig::CELL_SIZE * mapCellsPerCell;
+        dim = (MAP_CELLS + mapCellsPerCell - 1) / mapCellsPerCell;
+        origin = -(MAP_CELLS * GameConfig::CELL_SIZE) / 2.0f - GameConfig::CELL_SIZE * 0.5f;
+        cellHead.assign(dim * dim, -1);
+    }
+
+    int cellCoord(float v) const {
+        int c = (int)floorf((v - origin) / cellSize);
+        if(c < 0) c = 0;
+        if(c >= dim) c = dim - 1;
+        return c;
+    }
+
+    // Drop all items and size for ids in [0, count).
+    void clear(int count) {
+        itemX.resize(count); itemZ.resize(count); nextItem.resize(count);
+        memset(cellHead.data(), 0xFF, cellHead.size() * sizeof(int));
+    }
+
+    void insert(int id, Vec3 p) {
+        int cell = cellCoord(p.z) * dim + cellCoord(p.x);
+        itemX[id] = p.x; itemZ[id] = p.z;
+        nextItem[id] = cellHead[cell];
+        cellHead[cell] = id;
+    }
+
+    // Calls fn(id) for every item in the cells touched by the square of
+    // half-size `radius` around (x, z). Candidates only; callers do the
+    // exact test.
+    template<class Fn>
+    void forEachNear(float x, float z, float radius, Fn fn) const {
+        int x0 = cellCoord(x - radius), x1 = cellCoord(x + radius);
+        int z0 = cellCoord(z - radius), z1 = cellCoord(z + radius);
+        for(int gz=z0; gz<=z1; gz++) {
+            for(int gx=x0; gx<=x1; gx++) {
+                for(int id=cellHead[gz * dim + gx]; id>=0; id=nextItem[id]) fn(id);
+            }
+        }
+    }
+
+    // Nearest inserted id strictly closer than maxDist to (x, z), skipping
+    // `exclude`. Cells are visited in rings outward from the query cell and
+    // the search stops once no unvisited ring can beat the current best, so
+    // dense crowds resolve in the first ring or two. Returns -1 if none.
+    int nearest(float x, float z, float maxDist, int exclude, float& outDist) const {
+        int cx = cellCoord(x), cz = cellCoord(z);
+        int maxRing = (int)(maxDist / cellSize) + 1;
+        float bestSq = maxDist * maxDist;
+        int best = -1;
+
+        for(int r=0; r<=maxRing; r++) {
+            for(int gz=cz-r; gz<=cz+r; gz++) {
+                if(gz < 0 || gz >= dim) continue;
+                bool edgeRow = (gz == cz-r || gz == cz+r);
+                int step = edgeRow ? 1 : 2 * r;
+                for(int gx=cx-r; gx<=cx+r; gx+=(step > 0 ? step : 1)) {
+                    if(gx < 0 || gx >= dim) continue;
+                    for(int id=cellHead[gz * dim + gx]; id>=0; id=nextItem[id]) {
+                        if(id == exclude) continue;
+                        float dx = itemX[id] - x, dz = itemZ[id] - z;
+                        float dSq = dx*dx + dz*dz;
+                        if(dSq < bestSq || (dSq == bestSq && best >= 0 && id < best)) { bestSq = dSq; best = id; }
+                    }
+                }
+            }
+            float reach = r * cellSize;
+            if(best >= 0 && bestSq <= reach * reach) break;
+        }
+        if(best >= 0) outDist = sqrtf(bestSq);
+        return best;
+    }
+};
+
+typedef BasicSpatialGrid<GameConfig::MAP_SIZE, 0> SpatialGrid;
+#endif
@@ -1,51 +1,76 @@
 #ifndef WEAPON_SYSTEM_H
 #define WEAPON_SYSTEM_H
 #include <vector>
-#include "GameObject.h"
+#include "KinematicPool.h"
+#include "WorldMode.h"
+
+template<int CAPACITY>
+class BasicBulletPool : public BasicKinematicPool<CAPACITY> {
+    typedef BasicKinematicPool<CAPACITY> Base;
 
-class Bullet : public GameObject {
 public:
-    Vec3 velocity;
-    float life;
-    bool isPlayerBullet;
-    WeaponType type;
+    PoolVector<uint8_t, CAPACITY> isPlayerBullet;
+    PoolVector<WeaponType, CAPACITY> type;
 
     void spawn(Vec3 p, Vec3 dir, bool isP, WeaponType wType) {
-        pos = p;
-        life = 1.5f; isActive = true; isPlayerBullet = isP; type = wType;
-        
-        if(isP) color = (wType == WeaponType::BEAM) ? Vec3(0,1,1) : Vec3(1,1,0); 
-        else color = Vec3(1,0,0);
-        
-        float speed = GameConfig::BULLET_SPEED_STD;
-        if(wType == WeaponType::BEAM) { 
-            scaleV = Vec3(0.5f, 0.5f, 3.0f); 
-            speed = GameConfig::BULLET_SPEED_BEAM;
-        } else { 
-            scaleV = Vec3(0.2f, 0.2f, 0.2f);
-        }
-        velocity = dir * speed;
+        int i = this->acquire();
+        if(i < 0) return;
+        float speed = (wType == WeaponType::BEAM) ? GameConfig::BULLET_SPEED_BEAM : GameConfig::BULLET_SPEED_STD;
+        this->place(i, p, dir * speed, 1.5f);
+        isPlayerBullet[i] = isP; type[i] = wType;
+    }
+
+    // Visuals are a pure function of owner and weapon, so they are not stored.
+    Vec3 colorOf(int i) const {
+        if(isPlayerBullet[i]) return (type[i] == WeaponType::BEAM) ? Vec3(0,1,1) : Vec3(1,1,0);
+        return Vec3(1,0,0);
+    }
+
+    Vec3 scaleOf(int i) const {
+        return (type[i] == WeaponType::BEAM) ? Vec3(0.5f, 0.5f, 3.0f) : Vec3(0.2f, 0.2f, 0.2f);
+    }
+
+protected:
+    void saveSlot(ByteWriter& w, int i) const override {
+        Base::saveSlot(w, i);
+        w.u8(isPlayerBullet[i]); w.u8((uint8_t)type[i]);
+    }
+    void loadSlot(ByteReader& r, int i) override {
+        Base::loadSlot(r, i);
+        isPlayerBullet[i] = r.u8(); type[i] = (WeaponType)r.u8();
     }
 
-    void update(float dt) override {
-        if (!isActive) return;
-        pos = pos + (velocity * dt);
-        life -= dt; // Not clamping life is fine, checked next line
-        if (life <= 0.0f) isActive = false;
+    void resizeStorage(int n) override {
+        Base::resizeStorage(n);
+        isPlayerBullet.resize(n, 0);
+        type.resize(n, WeaponType::PISTOL);
     }
 };
 
-class WeaponSystem {
+typedef BasicBulletPool<0> BulletPool;
+
+template<class Mode>
+class BasicWeaponSystem {
 public:
-    std::vector<Bullet> bullets;
+    typedef BasicBulletPool<Mode::BULLET_SLOTS> BulletPoolType;
+
+    BulletPoolType bullets;
     bool eventShoot;
 
-    WeaponSystem() {
-        bullets.resize(100); 
+    BasicWeaponSystem() {
+        bullets.resize(GameConfig::BULLET_SLOTS);
+        reset();
+    }
+
+    void reset() {
         eventShoot = false;
+        bullets.clear();
     }
 
-    void update(float dt) { for(auto& b : bullets) b.update(dt); }
+    void update(float dt) { bullets.update(dt); }
+
+    void save(ByteWriter& w) const { w.u8(eventShoot); bullets.save(w); }
+    bool load(ByteReader& r) { eventShoot = r.u8() != 0; return bullets.load(r); }
 
     void fire(Vec3 origin, Vec3 dir, bool isPlayer, WeaponType wType) {
         if(wType == WeaponType::SHOTGUN) {
@@ -68,13 +93,12 @@ public:
     }
 
     void spawnBullet(Vec3 p, Vec3 d, bool isP, WeaponType t) {
-        for(auto& b : bullets) {
-            if(!b.isActive) { b.spawn(p, d, isP, t); return; }
-        }
+        bullets.spawn(p, d, isP, t);
     }
     
     bool consumeShootEvent() { if(eventShoot){ eventShoot=false; return true; } return false; }
-    void draw(Shader* s, Mat4& vp) { for(auto& b : bullets) b.draw(s, vp); }
 };
+
+typedef BasicWeaponSystem<StandardMode> WeaponSystem;
 #endif
 
@@ -0,0 +1,351 @@
+#ifndef WORLD_H
+#define WORLD_H
+#include "Player.h"
+#include "EntityManager.h"
+#include "WeaponSystem.h"
+#include "Map.h"
+#include "MapCache.h"
+#include "WorldMode.h"
+#include "../core/Profiler.h"
+
+// Controls as last reported by input(). Buttons latch until a tick
+// consumes them, so a press between two ticks is never lost.
+struct InputState {
+    float jx, jy;
+    bool fire, dash, ult;
+};
+
+// Called after every fixed tick advance() runs, with the world's
+// stateHash(); recorders and replays check the match against it. Worlds
+// only hash while a listener is attached.
+class TickListener {
+public:
+    virtual ~TickListener() {}
+    virtual void afterTick(uint64_t stateHash) = 0;
+};
+
+// GL-free match simulation. GameEngine wraps it with rendering; the
+// headless runner drives it directly. Every random decision in the match
+// draws from rng, so a seed fully determines the run.
+//
+// update(dt) is one simulation tick. advance(frameDt) runs as many fixed
+// SIM_HZ ticks as the frame time covers and leaves interpAlpha at the
+// fraction of a tick left over, so rendering can blend prevPos and pos.
+//
+// M fixes the map size and pool capacities at compile time (see
+// WorldMode.h); World is the standard mode the app plays.
+template<class M>
+class BasicWorld {
+public:
+    typedef M Mode;
+    typedef BasicMap<Mode::MAP_SIZE> MapType;
+    typedef BasicMapCache<MapType> MapCacheType;
+    typedef BasicWeaponSystem<Mode> WeaponSystemType;
+    typedef BasicEntityManager<Mode> EntityManagerType;
+
+    // Most bots a match may ask for: a fixed pool's size, or the global cap.
+    static constexpr int MAX_BOTS = Mode::BOT_SLOTS ? Mode::BOT_SLOTS : GameConfig::MAX_BOTS;
+
+    Random rng;
+    uint64_t seed;
+
+    Player* player;
+    WeaponSystemType* weapons;
+    EntityManagerType* entities;
+    const MapType* map; // read-only: may be shared through `maps`
+
+    int gameState;
+    float zoneRadius;
+    float cameraShake;
+    float slowMoTimer;
+
+    InputState pending;
+    float simDt;
+    float accumulator;
+    float interpAlpha;
+    int botCount; // bots spawned per match, at most MAX_BOTS
+    TickListener* tickListener; // not owned
+    MapCacheType* maps; // not owned; NULL generates every layout privately
+
+    BasicWorld(uint64_t seedValue = 1, MapCacheType* mapCache = NULL)
+        : map(NULL), simDt(1.0f / GameConfig::SIM_HZ), botCount(Mode::BOTS), tickListener(NULL), maps(mapCache) {
+        player = new Player();
+        weapons = new WeaponSystemType();
+        entities = new EntityManagerType(&rng);
+        reset(seedValue);
+    }
+
+    ~BasicWorld() { delete player; delete weapons; delete entities; }
+
+    // Next match draws its seed from the current stream, so `seed` always
+    // identifies the match being played.
+    void reset() {
+        uint64_t hi = rng.next();
+        reset((hi << 32) | rng.next());
+    }
+
+    // The same seed replays the same match.
+    void reset(uint64_t seedValue) {
+        seed = seedValue;
+        rng.seed(seedValue);
+        if(player) player->reset();
+        if(weapons) weapons->reset();
+        if(entities) entities->reset();
+        if(maps) {
+            mapRef = maps->acquire(seedValue, rng);
+            map = mapRef.get();
+        } else {
+            ownMap()->generateDerb(rng);
+        }
+        if(entities) entities->spawnBots(botCount);
+        gameState = 0;
+        zoneRadius = GameConfig::ZONE_START_RADIUS;
+        cameraShake = 0.0f;
+        slowMoTimer = 0.0f;
+        pending = InputState{0.0f, 0.0f, false, false, false};
+        accumulator = 0.0f;
+        interpAlpha = 1.0f;
+    }
+
+    // Ignores a rate outside [MIN_SIM_HZ, MAX_SIM_HZ]: update() would clamp
+    // its step and the match would drift from wall time.
+    void setSimRate(int hz) { if(hz >= GameConfig::MIN_SIM_HZ && hz <= GameConfig::MAX_SIM_HZ) simDt = 1.0f / hz; }
+    int simRate() const { return (int)lroundf(1.0f / simDt); }
+
+    // Bot AI fans out over `jobs` (not owned); results do not depend on it.
+    void setJobs(JobSystem* jobs) { entities->jobs = jobs; }
+
+    // FNV-1a over the state that decides the match: used to compare runs
+    // tick by tick.
+    uint64_t stateHash() const {
+        uint64_t h = 0xCBF29CE484222325ull;
+        auto mix = [&h](const void* p, size_t n) {
+            const unsigned char* b = (const unsigned char*)p;
+            for(size_t i=0; i<n; i++) { h ^= b[i]; h *= 0x100000001B3ull; }
+        };
+        mix(&player->pos, sizeof(Vec3)); mix(&player->hp, sizeof(float));
+        mix(&zoneRadius, sizeof(float)); mix(&gameState, sizeof(int));
+        for(int i : entities->botSlots.dense) {
+            const Bot& b = entities->bots[i];
+            mix(&i, sizeof(int)); mix(&b.pos, sizeof(Vec3)); mix(&b.hp, sizeof(float)); mix(&b.state, sizeof(BotState));
+        }
+        const auto& bp = weapons->bullets;
+        for(int i : bp.slots.dense) {
+            mix(&i, sizeof(int)); mix(&bp.px[i], sizeof(float)); mix(&bp.pz[i], sizeof(float));
+        }
+        return h;
+    }
+
+    // Snapshot of the whole match: restoring it into any world of the same
+    // mode continues tick for tick as this one would. Layout: "DRSN", u8
+    // version, the mode name (varint length, bytes), then each part in the
+    // order below. Floats are stored bit-exact; slot indices, counters and
+    // free lists are stored too, so later spawns land in the same slots.
+    // Nav fields are rebuilt on load, not stored.
+    static constexpr uint8_t SNAPSHOT_VERSION = 3;
+
+    void save(ByteWriter& w) const {
+        w.raw("DRSN", 4);
+        w.u8(SNAPSHOT_VERSION);
+        w.varint(strlen(Mode::NAME));
+        w.raw(Mode::NAME, strlen(Mode::NAME));
+        w.u64(seed);
+        rng.save(w);
+        w.varint(botCount); w.varint(simRate());
+        w.svarint(gameState);
+        w.pod(zoneRadius); w.pod(cameraShake); w.pod(slowMoTimer);
+        w.pod(pending.jx); w.pod(pending.jy);
+        w.u8((pending.fire ? 1 : 0) | (pending.dash ? 2 : 0) | (pending.ult ? 4 : 0));
+        w.pod(accumulator); w.pod(interpAlpha);
+        map->save(w);
+        player->save(w);
+        weapons->save(w);
+        entities->save(w);
+    }
+
+    // Returns false, with `error` set, on a foreign or corrupt snapshot or
+    // one taken in another mode. A bad header leaves the world untouched. A
+    // snapshot that breaks off part way restarts the match the world held
+    // before, with its old bot count and sim rate.
+    bool load(ByteReader& r, const char** error = NULL) {
+        const char* why = NULL;
+        char magic[4], name[32];
+        if(!r.raw(magic, 4) || memcmp(magic, "DRSN", 4) != 0) why = "not a snapshot";
+        else if(r.u8() != SNAPSHOT_VERSION) why = "unsupported snapshot version";
+        else {
+            size_t length = r.varint();
+            if(length >= sizeof(name) || !r.raw(name, length)) why = "truncated snapshot";
+            else {
+                name[length] = 0;
+                if(strcmp(name, Mode::NAME) != 0) why = "snapshot of another mode";
+            }
+        }
+        uint64_t seedValue = 0, bots = 0, hz = 0;
+        int64_t state = 0;
+        Random rngValue;
+        if(!why) {
+            seedValue = r.u64();
+            rngValue.load(r);
+            bots = r.varint(); hz = r.varint();
+            state = r.svarint();
+            if(!r.ok) why = "truncated snapshot";
+            else if(bots > (uint64_t)MAX_BOTS) why = "bot count out of range";
+            else if(hz < (uint64_t)GameConfig::MIN_SIM_HZ || hz > (uint64_t)GameConfig::MAX_SIM_HZ) why = "sim rate out of range";
+            else if(state < 0 || state > 2) why = "game state out of range";
+        }
+        if(why) { if(error) *error = why; return false; }
+
+        uint64_t oldSeed = seed;
+        int oldBots = botCount;
+        float oldDt = simDt;
+        seed = seedValue;
+        rng = rngValue;
+        botCount = (int)bots;
+        setSimRate((int)hz);
+        gameState = (int)state;
+        r.pod(zoneRadius); r.pod(cameraShake); r.pod(slowMoTimer);
+        r.pod(pending.jx); r.pod(pending.jy);
+        uint8_t buttons = r.u8();
+        pending.fire = (buttons & 1) != 0; pending.dash = (buttons & 2) != 0; pending.ult = (buttons & 4) != 0;
+        r.pod(accumulator); r.pod(interpAlpha);
+        ownMap()->load(r);
+        player->load(r);
+        if(!weapons->load(r) || !entities->load(r, *map) || !r.ok) {
+            if(error) *error = "truncated or corrupt snapshot";
+            botCount = oldBots;
+            simDt = oldDt;
+            reset(oldSeed);
+            return false;
+        }
+        return true;
+    }
+
+    void input(float jx, float jy, bool fire, bool dash, bool ult) {
+        pending.jx = jx; pending.jy = jy;
+        pending.fire |= fire; pending.dash |= dash; pending.ult |= ult;
+    }
+
+    // Runs whole ticks for frameDt seconds of wall time. Returns how many ran.
+    int advance(float frameDt) {
+        if(frameDt > GameConfig::MAX_FRAME_DT) frameDt = GameConfig::MAX_FRAME_DT;
+        if(frameDt < 0.0f) frameDt = 0.0f;
+        accumulator += frameDt;
+        int ticks = 0;
+        while(accumulator >= simDt) {
+            savePrevious();
+            update(simDt);
+            if(tickListener) tickListener->afterTick(stateHash());
+            accumulator -= simDt;
+            ticks++;
+        }
+        interpAlpha = accumulator / simDt;
+        return ticks;
+    }
+
+    void savePrevious() {
+        player->prevPos = player->pos;
+        player->aura.prevPos = player->aura.pos;
+        for(int i : entities->botSlots.dense) entities->bots[i].prevPos = entities->bots[i].pos;
+        weapons->bullets.savePrevious();
+        entities->particles.savePrevious();
+    }
+
+    void update(float dt) {
+        if(dt > 0.1f) dt = 0.1f;
+        if(dt < 0.001f) dt = 0.001f;
+
+        PROFILE_ZONE(PZ_TICK);
+        applyInput(dt);
+        simulate(dt);
+    }
+
+private:
+    std::shared_ptr<MapType> mapRef;
+
+    // Copy-on-write: a layout other worlds can see is never written; the
+    // world takes a private one first. Every writer replaces the whole
+    // layout, so there is nothing to copy over.
+    MapType* ownMap() {
+        if(!mapRef || mapRef.use_count() > 1) mapRef = std::make_shared<MapType>();
+        map = mapRef.get();
+        return mapRef.get();
+    }
+
+    // Player movement and actions happen inside the tick with the tick's dt.
+    void applyInput(float dt) {
+        PROFILE_ZONE(PZ_PLAYER);
+        InputState in = pending;
+        pending.fire = false; pending.dash = false; pending.ult = false;
+        if(gameState != 0) return;
+
+        float jx = in.jx, jy = in.jy;
+        if(jx>1.0f) jx=1.0f;
+        if(jx<-1.0f) jx=-1.0f;
+        if(jy>1.0f) jy=1.0f;
+        if(jy<-1.0f) jy=-1.0f;
+
+        Vec3 moveDir(jx, 0, jy);
+        if(moveDir.length() > 0.01f) {
+            player->pos = map->moveAndSlide(player->pos, moveDir * player->currentSpeed * dt, 1.0f);
+            player->setInput(jx, jy);
+        }
+
+        if(in.dash) { player->triggerDash(); cameraShake = 0.3f; }
+        if(in.ult) { player->triggerUlt(); cameraShake = 0.5f; }
+
+        if(in.fire && player->fireTimer <= 0.0f) {
+            Vec3 dir = moveDir;
+            if(dir.length() < 0.1f) dir = Vec3(0,0,-1); else dir.normalize();
+
+            WeaponType wType = WeaponType::PISTOL;
+            if (player->ultActive) wType = WeaponType::BEAM;
+
+            weapons->fire(player->pos, dir, true, wType);
+            player->fireTimer = (wType==WeaponType::BEAM) ? 0.1f : 0.3f;
+            cameraShake = 0.1f;
+        }
+    }
+
+    void simulate(float dt) {
+        float realDt = dt;
+
+        if (slowMoTimer > 0.0f) {
+            dt *= 0.2f;
+            slowMoTimer = fmax(0.0f, slowMoTimer - realDt);
+        }
+
+        if (gameState == 0) {
+            {
+                PROFILE_ZONE(PZ_ZONE);
+                if(zoneRadius > GameConfig::ZONE_MIN_RADIUS) zoneRadius -= GameConfig::ZONE_SHRINK_SPEED * dt;
+                if(player->pos.length() > zoneRadius) player->takeDamage(GameConfig::ZONE_DMG * dt);
+            }
+            {
+                PROFILE_ZONE(PZ_PLAYER);
+                player->update(dt);
+            }
+            {
+                PROFILE_ZONE(PZ_WEAPONS);
+                weapons->update(dt);
+            }
+            entities->update(dt, map, player, weapons);
+
+            if (player->isDead) gameState = 2;
+            else if (entities->botsAlive == 0) gameState = 1;
+
+            if (entities->killsThisTick > 0) slowMoTimer = 0.2f;
+            if (entities->eventBossKill) {
+                slowMoTimer = 1.0f;
+                cameraShake = 1.0f;
+                entities->eventBossKill = false;
+            }
+        }
+
+        if (cameraShake > 0.0f) cameraShake = fmax(0.0f, cameraShake - realDt);
+    }
+};
+
+typedef BasicWorld<StandardMode> World;
+typedef BasicWorld<MobileMode> MobileWorld;
+typedef BasicWorld<HordeMode> HordeWorld;
+#endif
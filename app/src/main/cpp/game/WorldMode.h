@@ -0,0 +1,48 @@
+#ifndef WORLD_MODE_H
+#define WORLD_MODE_H
+#include <string.h>
+#include "GameObject.h"
+
+// The compile-time shape of a match: map size, bots spawned per match and
+// the capacity of each pool. BasicWorld and the systems under it take one
+// of these as a template parameter. A capacity of 0 is a pool that starts
+// at GameConfig's *_SLOTS and doubles when full. Any other capacity is
+// that many slots in inline std::array storage, so a fixed mode never
+// allocates once its world is built, and its integration loops have a
+// constant trip count the compiler can unroll. A full fixed pool drops
+// the spawn (bots, bullets) or overwrites the oldest particle, and counts
+// the drop; modes are sized so that never happens.
+struct StandardMode {
+    static constexpr const char* NAME = "standard";
+    static constexpr int MAP_SIZE = GameConfig::MAP_SIZE;
+    static constexpr int BOTS = GameConfig::BOT_COUNT;
+    static constexpr int BOT_SLOTS = 0, BULLET_SLOTS = 0, PARTICLE_SLOTS = 0;
+};
+
+// Phones: a 32-cell map and a dozen bots.
+struct MobileMode {
+    static constexpr const char* NAME = "mobile";
+    static constexpr int MAP_SIZE = 32;
+    static constexpr int BOTS = 12;
+    static constexpr int BOT_SLOTS = 16, BULLET_SLOTS = 48, PARTICLE_SLOTS = 64;
+};
+
+// Stress mode: 1000 bots on the largest map the wall bitset allows.
+struct HordeMode {
+    static constexpr const char* NAME = "horde";
+    static constexpr int MAP_SIZE = 64;
+    static constexpr int BOTS = 1000;
+    static constexpr int BOT_SLOTS = 1024, BULLET_SLOTS = 2048, PARTICLE_SLOTS = 512;
+};
+
+// Calls fn(Mode()) for the mode called `name`, so a tool can pick the
+// world type from a flag or a file. False for an unknown name.
+template<class Fn>
+bool withWorldMode(const char* name, Fn fn) {
+    if(!strcmp(name, StandardMode::NAME)) fn(StandardMode());
+    else if(!strcmp(name, MobileMode::NAME)) fn(MobileMode());
+    else if(!strcmp(name, HordeMode::NAME)) fn(HordeMode());
+    else return false;
+    return true;
+}
+#endif
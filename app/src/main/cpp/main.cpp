@@ -1,6 +1,7 @@
 #include <jni.h>
 #include <GLES3/gl3.h>
 #include <android/log.h>
+#include "core/Profiler.h"
 
 #define LOG_TAG "DerbMBattle"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -9,6 +10,8 @@ extern "C"
 JNIEXPORT void JNICALL
 Java_com_derbmaroc_battle_MainActivity_nativeInit(JNIEnv* env, jobject thiz) {
     glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
+    Profiler::get().setSampleInterval(Profiler::APP_SAMPLE_INTERVAL);
+    Profiler::get().setEnabled(true);
     LOGI("Native Init Called");
 }
 
@@ -17,3 +20,21 @@ JNIEXPORT void JNICALL
 Java_com_derbmaroc_battle_MainActivity_nativeRender(JNIEnv* env, jobject thiz) {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
+
+// nativeInit records one frame in APP_SAMPLE_INTERVAL, under 1% of a
+// 30-bot frame. A debug setting can record every frame (sampleInterval 1,
+// about 25% of the same frame) or turn recording off.
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_derbmaroc_battle_MainActivity_nativeSetProfiling(JNIEnv* env, jobject thiz, jboolean enabled, jint sampleInterval) {
+    Profiler::get().setSampleInterval(sampleInterval);
+    Profiler::get().setEnabled(enabled == JNI_TRUE);
+}
+
+// Rolling per-zone p50/p99 of recent frames as JSON; "{}" when the
+// profiler is compiled out.
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_derbmaroc_battle_MainActivity_nativeGetProfileSummary(JNIEnv* env, jobject thiz) {
+    return env->NewStringUTF(Profiler::get().summaryJson().c_str());
+}
@@ -0,0 +1,69 @@
+#ifndef CUBE_BATCH_H
+#define CUBE_BATCH_H
+#include <vector>
+#include "../core/Shader.h"
+#include "../core/MathUtils.h"
+
+static const float CUBE[] = {
+    -0.5f,-0.5f,0.5f, 0.5f,-0.5f,0.5f, 0.5f,0.5f,0.5f, 0.5f,0.5f,0.5f, -0.5f,0.5f,0.5f, -0.5f,-0.5f,0.5f,
+    -0.5f,-0.5f,-0.5f, -0.5f,0.5f,-0.5f, 0.5f,0.5f,-0.5f, 0.5f,0.5f,-0.5f, 0.5f,-0.5f,-0.5f, -0.5f,-0.5f,-0.5f,
+    -0.5f,0.5f,-0.5f, -0.5f,0.5f,0.5f, 0.5f,0.5f,0.5f, 0.5f,0.5f,0.5f, 0.5f,0.5f,-0.5f, -0.5f,0.5f,-0.5f,
+    -0.5f,-0.5f,-0.5f, 0.5f,-0.5f,-0.5f, 0.5f,-0.5f,0.5f, 0.5f,-0.5f,0.5f, -0.5f,-0.5f,0.5f, -0.5f,-0.5f,-0.5f,
+    0.5f,-0.5f,-0.5f, 0.5f,0.5f,-0.5f, 0.5f,0.5f,0.5f, 0.5f,0.5f,0.5f, 0.5f,-0.5f,0.5f, 0.5f,-0.5f,-0.5f,
+    -0.5f,-0.5f,-0.5f, -0.5f,-0.5f,0.5f, -0.5f,0.5f,0.5f, -0.5f,0.5f,0.5f, -0.5f,0.5f,-0.5f, -0.5f,-0.5f,-0.5f
+};
+
+// Per-instance vertex data: column-major model matrix plus rgba.
+struct CubeInstance {
+    float model[16];
+    float color[4];
+};
+
+// Draws any number of axis-aligned cubes with one instanced draw call.
+// CUBE lives in a static VBO bound once into the VAO; callers add()
+// instances and flush() each category, which streams the instance buffer
+// and issues a single draw with the view-projection uploaded once.
+class CubeBatch {
+public:
+    unsigned vao, cubeVbo, instanceVbo;
+    std::vector<CubeInstance> instances;
+
+    CubeBatch() : vao(0), cubeVbo(0), instanceVbo(0) {}
+
+    void init(Shader* s) {
+        RenderDevice* dev = s->device;
+        vao = dev->createVertexArray();
+        cubeVbo = dev->createBuffer();
+        instanceVbo = dev->createBuffer();
+
+        dev->bindVertexArray(vao);
+        dev->bufferData(cubeVbo, CUBE, sizeof(CUBE), BufferUsage::STATIC);
+        dev->vertexAttrib(cubeVbo, s->posHandle, 3, 0, 0, 0);
+        for(int c=0; c<4; c++) {
+            dev->vertexAttrib(instanceVbo, s->modelHandle + c, 4, sizeof(CubeInstance), sizeof(float) * 4 * c, 1);
+        }
+        dev->vertexAttrib(instanceVbo, s->colorHandle, 4, sizeof(CubeInstance), sizeof(float) * 16, 1);
+        dev->bindVertexArray(0);
+    }
+
+    void add(Vec3 pos, Vec3 scaleV, Vec3 color, float alpha) {
+        instances.emplace_back();
+        CubeInstance& inst = instances.back();
+        Mat4::writeTRS(inst.model, pos, scaleV); // no rotation ever reaches here
+        inst.color[0] = color.x; inst.color[1] = color.y; inst.color[2] = color.z; inst.color[3] = alpha;
+    }
+
+    void flush(Shader* s, const Mat4& vp) {
+        if(instances.empty()) return;
+        RenderDevice* dev = s->device;
+        dev->uniformMatrix4(s->vpHandle, vp.m);
+
+        dev->bindVertexArray(vao);
+        dev->bufferData(instanceVbo, instances.data(), instances.size() * sizeof(CubeInstance), BufferUsage::STREAM);
+        dev->drawTrianglesInstanced(0, 36, (int)instances.size());
+        dev->bindVertexArray(0);
+
+        instances.clear();
+    }
+};
+#endif
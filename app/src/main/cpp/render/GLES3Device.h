@@ -0,0 +1,134 @@
+#ifndef GLES3_DEVICE_H
+#define GLES3_DEVICE_H
+#include <GLES3/gl3.h>
+#include "RenderDevice.h"
+
+class GLES3Device : public RenderDevice {
+protected:
+    void doSetupState(float r, float g, float b) override {
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glClearColor(r, g, b, 1.0f);
+    }
+
+    void doViewport(int w, int h) override { glViewport(0, 0, w, h); }
+    void doClear() override { glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); }
+
+    // 0 on failure, with the log appended to programLog.
+    GLuint loadShader(GLenum type, const char* src) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &src, NULL);
+        glCompileShader(shader);
+        GLint ok = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if(ok) return shader;
+        appendLog(type == GL_VERTEX_SHADER ? "vertex shader: " : "fragment shader: ", shader, false);
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    void appendLog(const char* what, GLuint object, bool isProgram) {
+        GLint len = 0;
+        if(isProgram) glGetProgramiv(object, GL_INFO_LOG_LENGTH, &len);
+        else glGetShaderiv(object, GL_INFO_LOG_LENGTH, &len);
+        std::string log(len > 1 ? len : 1, '\0');
+        if(isProgram) glGetProgramInfoLog(object, (GLsizei)log.size(), NULL, &log[0]);
+        else glGetShaderInfoLog(object, (GLsizei)log.size(), NULL, &log[0]);
+        log.resize(strlen(log.c_str()));
+        programLog += what;
+        programLog += log.empty() ? "failed, no log" : log;
+        programLog += "\n";
+    }
+
+    // Deletes `program` and returns 0 unless it linked.
+    GLuint checkLinked(GLuint program) {
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if(ok) return program;
+        appendLog("link: ", program, true);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    unsigned doCreateProgram(const char* vertexSrc, const char* fragmentSrc) override {
+        GLuint vs = loadShader(GL_VERTEX_SHADER, vertexSrc);
+        GLuint fs = loadShader(GL_FRAGMENT_SHADER, fragmentSrc);
+        if(!vs || !fs) {
+            if(vs) glDeleteShader(vs);
+            if(fs) glDeleteShader(fs);
+            return 0;
+        }
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(program);
+
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        return checkLinked(program);
+    }
+
+    bool doProgramBinary(unsigned program, std::vector<uint8_t>& out, uint32_t& format) override {
+        GLint formats = 0, len = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if(formats <= 0) return false;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &len);
+        if(len <= 0) return false;
+        out.resize(len);
+        GLenum fmt = 0;
+        GLsizei written = 0;
+        glGetProgramBinary(program, len, &written, &fmt, out.data());
+        if(glGetError() != GL_NO_ERROR || written <= 0) { out.clear(); return false; }
+        out.resize(written);
+        format = fmt;
+        return true;
+    }
+
+    // Drivers may refuse a binary at any time (an update, a different GPU
+    // mode); that shows up as a failed link.
+    unsigned doCreateProgramFromBinary(uint32_t format, const void* data, size_t bytes) override {
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, format, data, (GLsizei)bytes);
+        while(glGetError() != GL_NO_ERROR) {}
+        return checkLinked(program);
+    }
+
+    std::string doDriverId() override {
+        std::string id;
+        const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for(GLenum n : names) {
+            const GLubyte* s = glGetString(n);
+            id += s ? (const char*)s : "?";
+            id += '\n';
+        }
+        return id;
+    }
+
+    int doUniformLocation(unsigned program, const char* name) override { return glGetUniformLocation(program, name); }
+    void doUseProgram(unsigned program) override { glUseProgram(program); }
+    void doUniformMatrix4(int location, const float* m) override { glUniformMatrix4fv(location, 1, GL_FALSE, m); }
+
+    unsigned doCreateVertexArray() override { GLuint vao; glGenVertexArrays(1, &vao); return vao; }
+    void doBindVertexArray(unsigned vao) override { glBindVertexArray(vao); }
+    unsigned doCreateBuffer() override { GLuint buf; glGenBuffers(1, &buf); return buf; }
+
+    void doBufferData(unsigned buffer, const void* data, size_t bytes, BufferUsage usage) override {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, bytes, data, usage == BufferUsage::STATIC ? GL_STATIC_DRAW : GL_STREAM_DRAW);
+    }
+
+    void doVertexAttrib(unsigned buffer, unsigned location, int components, int stride, size_t offset, unsigned divisor) override {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(location, components, GL_FLOAT, GL_FALSE, stride, (const void*)offset);
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, divisor);
+    }
+
+    void doDrawTrianglesInstanced(int firstVertex, int vertexCount, int instanceCount) override {
+        glDrawArraysInstanced(GL_TRIANGLES, firstVertex, vertexCount, instanceCount);
+    }
+};
+#endif
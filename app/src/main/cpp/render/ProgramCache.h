@@ -0,0 +1,74 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+#include <stdio.h>
+#include <string>
+#include "RenderDevice.h"
+#include "../core/ByteStream.h"
+
+// Linked programs saved as driver binaries, one file per program in `dir`
+// (the app's private storage on device). Entries are keyed by a hash of
+// the driver id and both sources, so a driver update or a shader edit
+// just misses and recompiles. A binary the driver refuses is counted,
+// recompiled and overwritten.
+//
+// File layout: "DRPB" u8 version u64 key u32 format varint size, bytes.
+class ProgramCache {
+public:
+    static constexpr uint8_t VERSION = 1;
+
+    std::string dir;
+    int hits, misses, rejected, writes;
+
+    explicit ProgramCache(const char* directory) : dir(directory), hits(0), misses(0), rejected(0), writes(0) {}
+
+    static uint64_t key(const std::string& driver, const char* vertexSrc, const char* fragmentSrc) {
+        uint64_t h = 0xCBF29CE484222325ull;
+        auto mix = [&h](const char* p, size_t n) {
+            for(size_t i=0; i<n; i++) { h ^= (unsigned char)p[i]; h *= 0x100000001B3ull; }
+            h ^= 0xFF; h *= 0x100000001B3ull; // separator, so "ab"+"c" != "a"+"bc"
+        };
+        mix(driver.data(), driver.size());
+        mix(vertexSrc, strlen(vertexSrc));
+        mix(fragmentSrc, strlen(fragmentSrc));
+        return h;
+    }
+
+    std::string pathFor(uint64_t k) const {
+        char name[32];
+        snprintf(name, sizeof(name), "/prog-%016llx.bin", (unsigned long long)k);
+        return dir + name;
+    }
+
+    // The cached program for `k`, or 0 on a miss or a rejected binary.
+    unsigned load(RenderDevice* dev, uint64_t k) {
+        std::vector<uint8_t> data;
+        if(!readFile(pathFor(k).c_str(), data)) { misses++; return 0; }
+        ByteReader r(data.data(), data.size());
+        char magic[4];
+        bool ok = r.raw(magic, 4) && !memcmp(magic, "DRPB", 4) && r.u8() == VERSION && r.u64() == k;
+        uint32_t format = r.u32();
+        size_t size = r.varint();
+        if(!ok || !r.ok || size != r.remaining()) { rejected++; return 0; }
+        unsigned program = dev->createProgramFromBinary(format, r.p, size);
+        if(!program) { rejected++; return 0; }
+        hits++;
+        return program;
+    }
+
+    bool store(RenderDevice* dev, unsigned program, uint64_t k) {
+        std::vector<uint8_t> binary;
+        uint32_t format = 0;
+        if(!dev->programBinary(program, binary, format)) return false;
+        ByteWriter w;
+        w.raw("DRPB", 4);
+        w.u8(VERSION);
+        w.u64(k);
+        w.u32(format);
+        w.varint(binary.size());
+        w.raw(binary.data(), binary.size());
+        if(!w.save(pathFor(k).c_str())) return false;
+        writes++;
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,136 @@
+#ifndef RECORDING_DEVICE_H
+#define RECORDING_DEVICE_H
+#include <stdint.h>
+#include <vector>
+#include "RenderDevice.h"
+
+enum class RenderOp {
+    SETUP_STATE, VIEWPORT, CLEAR, CREATE_PROGRAM, USE_PROGRAM, UNIFORM_MAT4,
+    CREATE_VERTEX_ARRAY, BIND_VERTEX_ARRAY, CREATE_BUFFER, BUFFER_DATA, VERTEX_ATTRIB, DRAW_INSTANCED,
+    LOAD_PROGRAM_BINARY
+};
+
+struct RenderCommand {
+    RenderOp op;
+    int64_t a, b, c; // op-specific: ids, locations, counts, sizes
+};
+
+// GL-free backend: hands out fake object ids and appends every call to
+// `commands`, so off-device runs can inspect both the counters in
+// RenderDevice::frame and the exact command order.
+//
+// Program binaries are faked: a "binary" names the program's source hash
+// and the driver string, and loading one checks both, so cache hits,
+// misses and driver-change rejections can be exercised off device.
+class RecordingDevice : public RenderDevice {
+public:
+    static const uint32_t BINARY_FORMAT = 0x52454331; // "REC1"
+
+    std::vector<RenderCommand> commands;
+    bool recordCommands;
+    bool binaries;      // false acts like a driver with no binary formats
+    std::string driver; // change it to simulate a driver update
+
+    RecordingDevice(bool record = true) : recordCommands(record), binaries(true), driver("recording 1"), nextId(1) {}
+
+    void clearCommands() { commands.clear(); }
+
+    int count(RenderOp op) const {
+        int n = 0;
+        for(auto& c : commands) if(c.op == op) n++;
+        return n;
+    }
+
+protected:
+    unsigned nextId;
+
+    void push(RenderOp op, int64_t a = 0, int64_t b = 0, int64_t c = 0) {
+        if(recordCommands) commands.push_back(RenderCommand{op, a, b, c});
+    }
+
+    void doSetupState(float /*r*/, float /*g*/, float /*b*/) override { push(RenderOp::SETUP_STATE); }
+    void doViewport(int w, int h) override { push(RenderOp::VIEWPORT, w, h); }
+    void doClear() override { push(RenderOp::CLEAR); }
+
+    std::vector<std::pair<unsigned, uint64_t>> programSources; // program id -> source hash
+
+    static uint64_t hashText(uint64_t h, const char* s) {
+        for(; *s; s++) { h ^= (unsigned char)*s; h *= 0x100000001B3ull; }
+        return h;
+    }
+
+    unsigned doCreateProgram(const char* vertexSrc, const char* fragmentSrc) override {
+        unsigned id = nextId++;
+        programSources.push_back(std::make_pair(id, hashText(hashText(0xCBF29CE484222325ull, vertexSrc), fragmentSrc)));
+        push(RenderOp::CREATE_PROGRAM, id);
+        return id;
+    }
+
+    // Binary layout: u64 source hash, then the driver string.
+    bool doProgramBinary(unsigned program, std::vector<uint8_t>& out, uint32_t& format) override {
+        if(!binaries) return false;
+        for(auto& p : programSources) {
+            if(p.first != program) continue;
+            out.resize(8);
+            memcpy(out.data(), &p.second, 8);
+            out.insert(out.end(), driver.begin(), driver.end());
+            format = BINARY_FORMAT;
+            return true;
+        }
+        return false;
+    }
+
+    unsigned doCreateProgramFromBinary(uint32_t format, const void* data, size_t bytes) override {
+        const uint8_t* b = (const uint8_t*)data;
+        if(!binaries || format != BINARY_FORMAT || bytes != 8 + driver.size() ||
+           memcmp(b + 8, driver.data(), driver.size()) != 0) {
+            programLog = "link: binary rejected\n";
+            return 0;
+        }
+        uint64_t source;
+        memcpy(&source, b, 8);
+        unsigned id = nextId++;
+        programSources.push_back(std::make_pair(id, source));
+        push(RenderOp::LOAD_PROGRAM_BINARY, id);
+        return id;
+    }
+
+    std::string doDriverId() override { return driver; }
+
+    // Locations are stable small integers derived from the name.
+    int doUniformLocation(unsigned /*program*/, const char* name) override {
+        unsigned h = 0;
+        for(const char* p = name; *p; p++) h = h * 31 + (unsigned char)*p;
+        return (int)(h % 1024);
+    }
+
+    void doUseProgram(unsigned program) override { push(RenderOp::USE_PROGRAM, program); }
+    void doUniformMatrix4(int location, const float* /*m*/) override { push(RenderOp::UNIFORM_MAT4, location); }
+
+    unsigned doCreateVertexArray() override {
+        unsigned id = nextId++;
+        push(RenderOp::CREATE_VERTEX_ARRAY, id);
+        return id;
+    }
+
+    void doBindVertexArray(unsigned vao) override { push(RenderOp::BIND_VERTEX_ARRAY, vao); }
+
+    unsigned doCreateBuffer() override {
+        unsigned id = nextId++;
+        push(RenderOp::CREATE_BUFFER, id);
+        return id;
+    }
+
+    void doBufferData(unsigned buffer, const void* /*data*/, size_t bytes, BufferUsage usage) override {
+        push(RenderOp::BUFFER_DATA, buffer, (int64_t)bytes, (int64_t)usage);
+    }
+
+    void doVertexAttrib(unsigned buffer, unsigned location, int /*components*/, int /*stride*/, size_t /*offset*/, unsigned divisor) override {
+        push(RenderOp::VERTEX_ATTRIB, buffer, location, divisor);
+    }
+
+    void doDrawTrianglesInstanced(int firstVertex, int vertexCount, int instanceCount) override {
+        push(RenderOp::DRAW_INSTANCED, firstVertex, vertexCount, instanceCount);
+    }
+};
+#endif
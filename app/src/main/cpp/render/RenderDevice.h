@@ -0,0 +1,149 @@
+#ifndef RENDER_DEVICE_H
+#define RENDER_DEVICE_H
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Per-frame counters, reset by RenderDevice::beginFrame().
+struct FrameStats {
+    int drawCalls;
+    int instances;
+    int uniformUploads;
+    int uniformSkips; // uploads dropped because the program already held the value
+    int attribBinds;
+    int stateChanges;
+    int stateSkips;   // useProgram() of the program already in use
+    size_t bytesSubmitted;
+};
+
+enum class BufferUsage { STATIC, STREAM };
+
+// The only way the renderer talks to the GPU. GLES3Device forwards to the
+// driver; RecordingDevice keeps the command stream so render cost can be
+// measured without a GL context. Public calls are counted here, once, and
+// forwarded to the backend's do* hooks.
+//
+// The device also shadows the current program and every uniform value it
+// has uploaded, and drops calls that would not change either. GL keeps
+// uniform values per program, so the shadow is keyed by program and
+// location. After the context is lost, call invalidateState().
+class RenderDevice {
+public:
+    FrameStats frame;
+    std::string programLog; // compile/link log of the last createProgram() that failed
+
+    RenderDevice() : currentProgram(NO_PROGRAM) { beginFrame(); }
+    virtual ~RenderDevice() {}
+
+    void beginFrame() { memset(&frame, 0, sizeof(frame)); }
+
+    // Fixed pipeline setup: depth test, alpha blending, clear color.
+    void setupState(float r, float g, float b) { frame.stateChanges++; doSetupState(r, g, b); }
+    void viewport(int w, int h) { frame.stateChanges++; doViewport(w, h); }
+    void clear() { doClear(); }
+
+    // Forget the shadowed state; the next calls all reach the backend.
+    void invalidateState() {
+        currentProgram = NO_PROGRAM;
+        uniformCache.clear();
+    }
+
+    // Returns 0 on failure, with the driver's log in programLog.
+    unsigned createProgram(const char* vertexSrc, const char* fragmentSrc) {
+        programLog.clear();
+        return doCreateProgram(vertexSrc, fragmentSrc);
+    }
+
+    // Linked-program binaries, as glGetProgramBinary/glProgramBinary. Only
+    // valid on the driver build that made them, which driverId() names.
+    // False / 0 when unsupported or rejected; callers compile instead.
+    bool programBinary(unsigned program, std::vector<uint8_t>& out, uint32_t& format) {
+        out.clear();
+        return doProgramBinary(program, out, format);
+    }
+    unsigned createProgramFromBinary(uint32_t format, const void* data, size_t bytes) {
+        programLog.clear();
+        return doCreateProgramFromBinary(format, data, bytes);
+    }
+    std::string driverId() { return doDriverId(); }
+
+    int uniformLocation(unsigned program, const char* name) { return doUniformLocation(program, name); }
+    void useProgram(unsigned program) {
+        if(program == currentProgram) { frame.stateSkips++; return; }
+        frame.stateChanges++;
+        currentProgram = program;
+        doUseProgram(program);
+    }
+    // Applies to the program in use, like glUniform*.
+    void uniformMatrix4(int location, const float* m) {
+        CachedMat4* c = cachedUniform(location);
+        if(c->set && !memcmp(c->m, m, sizeof(c->m))) { frame.uniformSkips++; return; }
+        memcpy(c->m, m, sizeof(c->m));
+        c->set = true;
+        frame.uniformUploads++;
+        frame.bytesSubmitted += 16 * sizeof(float);
+        doUniformMatrix4(location, m);
+    }
+
+    unsigned createVertexArray() { return doCreateVertexArray(); }
+    void bindVertexArray(unsigned vao) { frame.stateChanges++; doBindVertexArray(vao); }
+    unsigned createBuffer() { return doCreateBuffer(); }
+    void bufferData(unsigned buffer, const void* data, size_t bytes, BufferUsage usage) {
+        frame.bytesSubmitted += bytes;
+        doBufferData(buffer, data, bytes, usage);
+    }
+    // Float attribute sourced from `buffer` in the bound vertex array;
+    // divisor 1 advances it per instance.
+    void vertexAttrib(unsigned buffer, unsigned location, int components, int stride, size_t offset, unsigned divisor) {
+        frame.attribBinds++;
+        doVertexAttrib(buffer, location, components, stride, offset, divisor);
+    }
+
+    void drawTrianglesInstanced(int firstVertex, int vertexCount, int instanceCount) {
+        frame.drawCalls++;
+        frame.instances += instanceCount;
+        doDrawTrianglesInstanced(firstVertex, vertexCount, instanceCount);
+    }
+
+protected:
+    static const unsigned NO_PROGRAM = ~0u;
+
+    virtual void doSetupState(float r, float g, float b) = 0;
+    virtual void doViewport(int w, int h) = 0;
+    virtual void doClear() = 0;
+    virtual unsigned doCreateProgram(const char* vertexSrc, const char* fragmentSrc) = 0;
+    virtual int doUniformLocation(unsigned program, const char* name) = 0;
+    virtual void doUseProgram(unsigned program) = 0;
+    virtual void doUniformMatrix4(int location, const float* m) = 0;
+    virtual unsigned doCreateVertexArray() = 0;
+    virtual void doBindVertexArray(unsigned vao) = 0;
+    virtual unsigned doCreateBuffer() = 0;
+    virtual void doBufferData(unsigned buffer, const void* data, size_t bytes, BufferUsage usage) = 0;
+    virtual void doVertexAttrib(unsigned buffer, unsigned location, int components, int stride, size_t offset, unsigned divisor) = 0;
+    virtual void doDrawTrianglesInstanced(int firstVertex, int vertexCount, int instanceCount) = 0;
+    virtual bool doProgramBinary(unsigned /*program*/, std::vector<uint8_t>& /*out*/, uint32_t& /*format*/) { return false; }
+    virtual unsigned doCreateProgramFromBinary(uint32_t /*format*/, const void* /*data*/, size_t /*bytes*/) { return 0; }
+    virtual std::string doDriverId() { return ""; }
+
+private:
+    struct CachedMat4 {
+        unsigned program;
+        int location;
+        bool set;
+        float m[16];
+    };
+
+    unsigned currentProgram;
+    std::vector<CachedMat4> uniformCache; // a handful of entries; linear search
+
+    CachedMat4* cachedUniform(int location) {
+        for(auto& c : uniformCache) if(c.program == currentProgram && c.location == location) return &c;
+        uniformCache.emplace_back();
+        CachedMat4& c = uniformCache.back();
+        c.program = currentProgram; c.location = location; c.set = false;
+        return &c;
+    }
+};
+#endif
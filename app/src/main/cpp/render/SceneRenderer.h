@@ -0,0 +1,121 @@
+#ifndef SCENE_RENDERER_H
+#define SCENE_RENDERER_H
+#include <vector>
+#include "../core/Shader.h"
+#include "../core/Frustum.h"
+#include "../core/Profiler.h"
+#include "../game/World.h"
+#include "CubeBatch.h"
+#include "WallMeshes.h"
+
+enum CullSet { CULL_WALL_CHUNKS, CULL_CHARACTERS, CULL_PARTICLES, CULL_BULLETS, CULL_SET_COUNT };
+
+// Visible/culled counts per drawable set for the last drawn frame.
+struct CullStats {
+    int visible[CULL_SET_COUNT];
+    int culled[CULL_SET_COUNT];
+};
+
+// All drawing of a world, of any mode, lives here, issued through the
+// Shader's RenderDevice, so the simulation headers stay GL-free. Every set
+// is frustum-culled against the frame's view-projection before it reaches
+// the device. Walls come from meshes baked per map layout; each dynamic set (characters, particles,
+// bullets) is one instanced draw. Dynamic objects are drawn at world's
+// interpAlpha between their last two tick positions; culling uses the
+// current position, which the bounding radii comfortably cover.
+class SceneRenderer {
+public:
+    // Bounding-sphere radii: half the diagonal of the largest cube each set draws.
+    static constexpr float CHARACTER_RADIUS = 1.5f;  // boss/ult scale 1.5
+    static constexpr float PARTICLE_RADIUS = 0.5f;   // largest emitter size 0.5
+    static constexpr float BULLET_RADIUS = 1.6f;     // beam is 0.5 x 0.5 x 3
+
+    CubeBatch batch;
+    WallMeshes walls;
+    Frustum frustum;
+    CullStats cull;
+    std::vector<int> visibleSlots;
+    std::vector<int> particleLanes;
+
+    void init(Shader* s) { batch.init(s); walls.init(s); }
+
+    void addObject(const GameObject& o, CullSet set, float t) {
+        if (!o.isActive) return;
+        if (!frustum.sphereVisible(o.pos.x, o.pos.y, o.pos.z, CHARACTER_RADIUS)) { cull.culled[set]++; return; }
+        cull.visible[set]++;
+        batch.add(o.renderPos(t), o.scaleV, o.color, o.alpha);
+    }
+
+    // Culls a pool's live slots in one batched pass; visibleSlots holds the survivors.
+    template<class Pool>
+    int cullPool(const Pool& pool, float radius, CullSet set) {
+        const auto& live = pool.slots.dense;
+        visibleSlots.resize(live.size());
+        int n = frustum.cullSpheres(pool.px.data(), pool.py.data(), pool.pz.data(),
+                                    live.data(), (int)live.size(), radius, visibleSlots.data());
+        cull.visible[set] += n;
+        cull.culled[set] += (int)live.size() - n;
+        return n;
+    }
+
+    // The ring's live range in spawn order, minus lanes that expired
+    // behind an older particle; then culled like a pool.
+    template<class Ring>
+    int cullParticles(const Ring& parts, CullSet set) {
+        particleLanes.clear();
+        for(uint32_t p=parts.head; p!=parts.tail; p++) {
+            int i = parts.lane(p);
+            if(parts.isActive(i)) particleLanes.push_back(i);
+        }
+        visibleSlots.resize(particleLanes.size());
+        int n = frustum.cullSpheres(parts.px.data(), parts.py.data(), parts.pz.data(),
+                                    particleLanes.data(), (int)particleLanes.size(), PARTICLE_RADIUS, visibleSlots.data());
+        cull.visible[set] += n;
+        cull.culled[set] += (int)particleLanes.size() - n;
+        return n;
+    }
+
+    template<class W>
+    void drawWorld(Shader* s, W* world, Mat4& vp) {
+        memset(&cull, 0, sizeof(cull));
+        frustum.extract(vp);
+
+        {
+            PROFILE_ZONE(PZ_WALL_DRAW);
+            cull.visible[CULL_WALL_CHUNKS] = walls.draw(*world->map, s, vp, frustum, cull.culled[CULL_WALL_CHUNKS]);
+        }
+        drawEntities(s, world, vp);
+    }
+
+    // Characters, particles and bullets: one culled, instanced batch each.
+    template<class W>
+    void drawEntities(Shader* s, W* world, Mat4& vp) {
+        PROFILE_ZONE(PZ_ENTITY_DRAW);
+        Player* player = world->player;
+        float t = world->interpAlpha;
+
+        if(player->aura.isActive) addObject(player->aura, CULL_CHARACTERS, t);
+        addObject(*player, CULL_CHARACTERS, t);
+        auto* em = world->entities;
+        for(int i : em->botSlots.dense) addObject(em->bots[i], CULL_CHARACTERS, t);
+        batch.flush(s, vp);
+
+        const auto& parts = em->particles;
+        int n = cullParticles(parts, CULL_PARTICLES);
+        for(int k=0; k<n; k++) {
+            int i = visibleSlots[k];
+            float size = parts.sizeOf(i);
+            batch.add(parts.renderPos(i, t), Vec3(size, size, size), parts.colorOf(i), parts.alphaOf(i));
+        }
+        batch.flush(s, vp);
+
+        const auto& bullets = world->weapons->bullets;
+        n = cullPool(bullets, BULLET_RADIUS, CULL_BULLETS);
+        for(int k=0; k<n; k++) {
+            int i = visibleSlots[k];
+            batch.add(bullets.renderPos(i, t), bullets.scaleOf(i), bullets.colorOf(i), 1.0f);
+        }
+        batch.flush(s, vp);
+    }
+};
+#endif
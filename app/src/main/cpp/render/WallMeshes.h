@@ -0,0 +1,129 @@
+#ifndef WALL_MESHES_H
+#define WALL_MESHES_H
+#include <vector>
+#include "../game/Map.h"
+#include "CubeBatch.h"
+#include "../core/Frustum.h"
+
+// Static wall geometry baked once per map layout, for a map of any size.
+// Walls are grouped into CHUNK_CELLS x CHUNK_CELLS chunks whose world-space
+// triangles sit back to back in one VBO, so a frame frustum-culls per chunk and draws each run of
+// consecutive visible chunks with a single call. Faces shared by two wall
+// cells are never visible and are not emitted.
+class WallMeshes {
+public:
+    static const int CHUNK_CELLS = 8;
+
+    struct Chunk {
+        int firstVertex, vertexCount;
+        Vec3 min, max;
+    };
+
+    std::vector<Chunk> chunks;
+    std::vector<float> vertices;
+    unsigned vao, vbo, instanceVbo;
+    unsigned bakedRevision;
+
+    WallMeshes() : vao(0), vbo(0), instanceVbo(0), bakedRevision(0) {}
+
+    // The shader is instanced, so walls are drawn as one instance whose
+    // model is identity and whose color is the wall color.
+    void init(Shader* s) {
+        RenderDevice* dev = s->device;
+        vao = dev->createVertexArray();
+        vbo = dev->createBuffer();
+        instanceVbo = dev->createBuffer();
+
+        CubeInstance wall;
+        Mat4 identity;
+        memcpy(wall.model, identity.m, sizeof(wall.model));
+        wall.color[0] = 0.4f; wall.color[1] = 0.4f; wall.color[2] = 0.5f; wall.color[3] = 1.0f;
+
+        dev->bindVertexArray(vao);
+        dev->bufferData(instanceVbo, &wall, sizeof(wall), BufferUsage::STATIC);
+        dev->vertexAttrib(vbo, s->posHandle, 3, 0, 0, 0);
+        for(int c=0; c<4; c++) {
+            dev->vertexAttrib(instanceVbo, s->modelHandle + c, 4, sizeof(CubeInstance), sizeof(float) * 4 * c, 1);
+        }
+        dev->vertexAttrib(instanceVbo, s->colorHandle, 4, sizeof(CubeInstance), sizeof(float) * 16, 1);
+        dev->bindVertexArray(0);
+    }
+
+    template<class MapT>
+    void bake(const MapT& map, Shader* s) {
+        const int N = MapT::N;
+        const int chunksPerSide = (N + CHUNK_CELLS - 1) / CHUNK_CELLS;
+        const float cell = GameConfig::CELL_SIZE;
+        const float offset = (N * cell) / 2.0f;
+        // CUBE face order: +z, -z, +y, -y, +x, -x. Side faces are skipped
+        // when the neighbouring cell in that direction is also a wall.
+        const int faceDx[6] = { 0, 0, 0, 0, 1, -1 };
+        const int faceDz[6] = { 1, -1, 0, 0, 0, 0 };
+
+        vertices.clear();
+        chunks.clear();
+        for(int cz=0; cz<chunksPerSide; cz++) {
+            for(int cx=0; cx<chunksPerSide; cx++) {
+                Chunk c;
+                c.firstVertex = (int)(vertices.size() / 3);
+                c.min = Vec3(cx * CHUNK_CELLS * cell - offset - cell * 0.5f, -cell * 0.5f,
+                             cz * CHUNK_CELLS * cell - offset - cell * 0.5f);
+                c.max = c.min + Vec3(CHUNK_CELLS * cell, cell, CHUNK_CELLS * cell);
+
+                for(int i=cx*CHUNK_CELLS; i<(cx+1)*CHUNK_CELLS && i<N; i++) {
+                    for(int j=cz*CHUNK_CELLS; j<(cz+1)*CHUNK_CELLS && j<N; j++) {
+                        if(!map.isWall(i, j)) continue;
+                        float wx = (i * cell) - offset;
+                        float wz = (j * cell) - offset;
+                        for(int f=0; f<6; f++) {
+                            int ni = i + faceDx[f], nj = j + faceDz[f];
+                            if((faceDx[f] || faceDz[f]) && map.isWall(ni, nj)) continue;
+                            for(int v=0; v<6; v++) {
+                                const float* p = &CUBE[(f * 6 + v) * 3];
+                                vertices.push_back(wx + p[0] * cell);
+                                vertices.push_back(p[1] * cell);
+                                vertices.push_back(wz + p[2] * cell);
+                            }
+                        }
+                    }
+                }
+                c.vertexCount = (int)(vertices.size() / 3) - c.firstVertex;
+                chunks.push_back(c);
+            }
+        }
+
+        s->device->bufferData(vbo, vertices.data(), vertices.size() * sizeof(float), BufferUsage::STATIC);
+        bakedRevision = map.revision;
+    }
+
+    // Draws the chunks whose bounds touch the frustum; adjacent visible
+    // chunks share one draw call. Returns how many non-empty chunks were
+    // visible and adds the rest to `culled`.
+    template<class MapT>
+    int draw(const MapT& map, Shader* s, const Mat4& vp, const Frustum& frustum, int& culled) {
+        if(bakedRevision != map.revision) bake(map, s);
+
+        RenderDevice* dev = s->device;
+        bool bound = false;
+        int runFirst = 0, runCount = 0, visible = 0;
+        auto flushRun = [&]() {
+            if(runCount == 0) return;
+            if(!bound) { dev->uniformMatrix4(s->vpHandle, vp.m); dev->bindVertexArray(vao); bound = true; }
+            dev->drawTrianglesInstanced(runFirst, runCount, 1);
+            runCount = 0;
+        };
+
+        for(auto& c : chunks) {
+            if(c.vertexCount == 0) continue; // contributes nothing, never splits a run
+            if(!frustum.aabbVisible(c.min, c.max)) { culled++; flushRun(); continue; }
+            visible++;
+            if(runCount > 0 && c.firstVertex == runFirst + runCount) { runCount += c.vertexCount; continue; }
+            flushRun();
+            runFirst = c.firstVertex; runCount = c.vertexCount;
+        }
+        flushRun();
+        if(bound) dev->bindVertexArray(0);
+        return visible;
+    }
+};
+#endif
@@ -0,0 +1,35 @@
+#ifndef PILOT_H
+#define PILOT_H
+#include "game/World.h"
+
+// Stand-in for the touch controls, shared by the Linux tools: head for the
+// nearest live bot and shoot at it, stay inside the zone, dash when hurt
+// and ult whenever it's ready.
+struct PilotInput {
+    float x, z;
+    bool fire, dash, ult;
+};
+
+template<class W>
+static PilotInput pilot(const W& w) {
+    const Player* p = w.player;
+    Vec3 aim(0,0,0);
+    float best = 1e9f;
+    for(int i : w.entities->botSlots.dense) {
+        const Bot& b = w.entities->bots[i];
+        if(b.isDead) continue;
+        float d = (b.pos - p->pos).length();
+        if(d < best) { best = d; aim = b.pos - p->pos; }
+    }
+    if(p->pos.length() > w.zoneRadius * 0.8f) aim = p->pos * -1.0f;
+    aim.normalize();
+    PilotInput in = { aim.x, aim.z, true, p->hp < p->maxHp * 0.5f, p->ultCooldown <= 0.0f };
+    return in;
+}
+
+template<class W>
+static void pilotInput(W& w) {
+    PilotInput in = pilot(w);
+    w.input(in.x, in.z, in.fire, in.dash, in.ult);
+}
+#endif
@@ -0,0 +1,135 @@
+// Multi-match host: keeps --slots matches resident at once and plays
+// -m matches in total on a thread pool with the scripted pilot, for bot
+// tuning and bulk re-simulation. Reports matches/s per core and resident
+// memory per hosted match. --seed-cycle k repeats seeds every k matches,
+// so concurrent matches on the same seed share one map layout;
+// --no-map-cache gives every world its own. --mode picks the world type
+// (standard, mobile, horde: map size, bot count and pool capacities, see
+// WorldMode.h); --bots overrides its bot count.
+// The result hash covers every finished match and must not change with
+// --threads.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <chrono>
+#include "game/MatchHost.h"
+#include "tools/Pilot.h"
+
+struct HostOptions {
+    int slots;
+    long long matches;
+    int ticks;
+    int slice;
+    int threads;
+    const char* modeName;
+    int bots; // 0 = the mode's
+    uint64_t seed;
+    int seedCycle;
+    bool mapCache;
+};
+
+static void printUsage(const char* exe) {
+    printf("usage: %s [--slots n] [-m matches] [-t max_ticks] [--slice ticks] [--threads n]\n"
+           "       [--mode standard|mobile|horde] [--bots n] [--seed n] [--seed-cycle k] [--no-map-cache]\n", exe);
+}
+
+static bool parseArgs(int argc, char** argv, HostOptions& opt) {
+    int hw = (int)std::thread::hardware_concurrency();
+    opt.slots = 200; opt.matches = 1000; opt.ticks = 3600; opt.slice = 60;
+    opt.threads = hw > 0 ? hw : 1; opt.modeName = StandardMode::NAME; opt.bots = 0; opt.seed = 1;
+    opt.seedCycle = 0; opt.mapCache = true;
+    for(int i=1; i<argc; i++) {
+        const char* a = argv[i];
+        bool hasNext = i + 1 < argc;
+        if(!strcmp(a, "--slots") && hasNext) opt.slots = atoi(argv[++i]);
+        else if((!strcmp(a, "-m") || !strcmp(a, "--matches")) && hasNext) opt.matches = atoll(argv[++i]);
+        else if((!strcmp(a, "-t") || !strcmp(a, "--ticks")) && hasNext) opt.ticks = atoi(argv[++i]);
+        else if(!strcmp(a, "--slice") && hasNext) opt.slice = atoi(argv[++i]);
+        else if(!strcmp(a, "--threads") && hasNext) opt.threads = atoi(argv[++i]);
+        else if(!strcmp(a, "--mode") && hasNext) {
+            opt.modeName = argv[++i];
+            if(!withWorldMode(opt.modeName, [](auto) {})) { printUsage(argv[0]); return false; }
+        }
+        else if(!strcmp(a, "--bots") && hasNext) opt.bots = atoi(argv[++i]);
+        else if(!strcmp(a, "--seed") && hasNext) opt.seed = strtoull(argv[++i], NULL, 10);
+        else if(!strcmp(a, "--seed-cycle") && hasNext) opt.seedCycle = atoi(argv[++i]);
+        else if(!strcmp(a, "--no-map-cache")) opt.mapCache = false;
+        else { printUsage(argv[0]); return false; }
+    }
+    return opt.slots > 0 && opt.matches > 0 && opt.ticks > 0 && opt.slice > 0 && opt.threads > 0;
+}
+
+// Resident set size in bytes, from /proc.
+static long long residentBytes() {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if(!f) return 0;
+    long long pages = 0, resident = 0;
+    if(fscanf(f, "%lld %lld", &pages, &resident) != 2) resident = 0;
+    fclose(f);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Heap bytes in use: unlike RSS this drops when memory is freed, so it
+// shows what the hosted matches actually hold. 0 where unavailable.
+static long long heapBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return (long long)mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+template<class Mode>
+static int run(const HostOptions& opt) {
+    typedef BasicMatchHost<Mode> Host;
+    typedef typename Host::WorldType WorldType;
+    int bots = opt.bots > 0 ? opt.bots : Mode::BOTS;
+    if(bots > WorldType::MAX_BOTS) {
+        printf("FAIL: %s mode holds at most %d bots\n", Mode::NAME, WorldType::MAX_BOTS);
+        return 1;
+    }
+
+    JobSystem jobs(opt.threads);
+    typename WorldType::MapCacheType maps;
+    long long rssBefore = residentBytes(), heapBefore = heapBytes();
+    Host host(opt.slots, opt.matches, opt.seed, bots, opt.mapCache ? &maps : NULL);
+    host.sliceTicks = opt.slice;
+    host.maxTicks = opt.ticks;
+    host.seedCycle = opt.seedCycle;
+    host.input = pilotInput<WorldType>;
+
+    long long rssPeak = 0, heapPeak = 0;
+    int rounds = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(bool more = true; more; rounds++) {
+        more = host.round(jobs);
+        // Pools have grown to their working size after the first few rounds.
+        if(rounds == 8) { rssPeak = residentBytes(); heapPeak = heapBytes(); }
+        if(opt.mapCache) maps.trim();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(rssPeak == 0) { rssPeak = residentBytes(); heapPeak = heapBytes(); }
+
+    const HostStats& s = host.stats;
+    double mps = seconds > 0.0 ? s.finished / seconds : 0.0;
+    printf("host mode=%s slots=%d threads=%d bots=%d matches=%lld wins=%lld losses=%lld timeouts=%lld ticks=%lld rounds=%d\n",
+           Mode::NAME, opt.slots, opt.threads, bots, s.finished, s.wins, s.losses, s.timeouts, s.ticks, rounds);
+    printf("throughput wall_s=%.3f matches_per_s=%.1f matches_per_s_per_core=%.1f ticks_per_s=%.0f result_hash=%016llx\n",
+           seconds, mps, mps / opt.threads, seconds > 0.0 ? s.ticks / seconds : 0.0, (unsigned long long)s.resultHash);
+    printf("memory rss_per_match_bytes=%.0f heap_per_match_bytes=%.0f map_cache=%s map_hits=%d map_misses=%d\n",
+           (double)(rssPeak - rssBefore) / opt.slots, (double)(heapPeak - heapBefore) / opt.slots,
+           opt.mapCache ? "on" : "off", maps.hits, maps.misses);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    HostOptions opt;
+    if(!parseArgs(argc, argv, opt)) return 1;
+    int rc = 1;
+    withWorldMode(opt.modeName, [&](auto mode) { rc = run<decltype(mode)>(opt); });
+    return rc;
+}
@@ -0,0 +1,548 @@
+// Headless batch runner: plays N matches for up to M ticks each against a
+// scripted pilot, with no GL context, and reports outcomes and ticks/sec.
+// With --render-stats every tick is also rendered into a RecordingDevice
+// and per-frame render counters are reported; --max-draw-calls turns the
+// run into a pass/fail check for CI, and any rendered run fails (exit 2)
+// if a repeated frame re-sends its program or matrices. Rendered runs go
+// through the fixed-step loop: the sim ticks at 1/dt while frames arrive
+// at --fps.
+// --threads runs bot AI on a JobSystem; --verify-threads plays every match
+// twice in lockstep, single-threaded and on N threads, and fails (exit 3)
+// on the first tick whose state hash differs. --profile records profiler
+// zones, prints the per-zone summary and writes a Chrome trace.
+// --record captures the first match (rendered path) as an input recording;
+// --replay plays one back -m times at full speed and fails (exit 3) if
+// any tick's state hash differs from the one recorded. --mode picks the
+// world type (map size, bot count and pool capacities, see WorldMode.h);
+// it and --no-ai-lod apply to every path except --replay, which uses the
+// settings it was recorded with.
+// --program-cache dir loads the shader from (and saves it to) a program
+// binary cache in dir, as the app does on device.
+// --verify-snapshot T snapshots every match at tick T, restores it into a
+// second world and plays both in lockstep to the end, failing (exit 3) on
+// the first differing tick; --snapshot also writes match 0's snapshot to a
+// file and restores from that file. Match 0's snapshot is also restored
+// with single bytes corrupted: header damage must be refused, and no
+// corruption may hang, crash or leave a refused world half restored.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "GameEngine.h"
+#include "render/RecordingDevice.h"
+#include "tools/Pilot.h"
+
+struct RunnerOptions {
+    int matches;
+    int ticks;
+    float dt;
+    int fps; // 0 = one frame per tick
+    uint64_t seed;
+    bool verbose;
+    bool renderStats;
+    int maxDrawCalls; // 0 = no limit
+    int bots; // 0 = the mode's
+    const char* modeName;
+    int threads;
+    int verifyThreads; // 0 = off
+    int grain;         // 0 = EntityManager default
+    bool aiLod;
+    const char* profilePath; // Chrome trace output, NULL = profiler off
+    const char* recordPath;
+    const char* replayPath;
+    int verifySnapshot; // tick to snapshot at; -1 = off
+    const char* snapshotPath;
+    const char* programCacheDir;
+};
+
+static void printUsage(const char* exe) {
+    printf("usage: %s [-m matches] [-t ticks] [--dt seconds] [--seed n] [-v]\n"
+           "       [--render-stats] [--max-draw-calls n] [--fps n]\n"
+           "       [--mode standard|mobile|horde] [--bots n]\n"
+           "       [--threads n] [--verify-threads n] [--grain n] [--no-ai-lod]\n"
+           "       [--profile trace.json] [--record file] [--replay file]\n"
+           "       [--verify-snapshot tick] [--snapshot file] [--program-cache dir]\n", exe);
+}
+
+static bool parseArgs(int argc, char** argv, RunnerOptions& opt) {
+    opt.matches = 10; opt.ticks = 3600; opt.dt = 1.0f / 60.0f; opt.seed = 1; opt.verbose = false;
+    opt.renderStats = false; opt.maxDrawCalls = 0; opt.fps = 0;
+    opt.bots = 0; opt.modeName = StandardMode::NAME; opt.threads = 1; opt.verifyThreads = 0; opt.grain = 0;
+    opt.aiLod = true; opt.profilePath = NULL; opt.recordPath = NULL; opt.replayPath = NULL;
+    opt.verifySnapshot = -1; opt.snapshotPath = NULL; opt.programCacheDir = NULL;
+    for(int i=1; i<argc; i++) {
+        const char* a = argv[i];
+        bool hasNext = i + 1 < argc;
+        if((!strcmp(a, "-m") || !strcmp(a, "--matches")) && hasNext) opt.matches = atoi(argv[++i]);
+        else if((!strcmp(a, "-t") || !strcmp(a, "--ticks")) && hasNext) opt.ticks = atoi(argv[++i]);
+        else if(!strcmp(a, "--dt") && hasNext) opt.dt = (float)atof(argv[++i]);
+        else if(!strcmp(a, "--seed") && hasNext) opt.seed = strtoull(argv[++i], NULL, 10);
+        else if(!strcmp(a, "-v") || !strcmp(a, "--verbose")) opt.verbose = true;
+        else if(!strcmp(a, "--render-stats")) opt.renderStats = true;
+        else if(!strcmp(a, "--max-draw-calls") && hasNext) { opt.maxDrawCalls = atoi(argv[++i]); opt.renderStats = true; }
+        else if(!strcmp(a, "--fps") && hasNext) { opt.fps = atoi(argv[++i]); opt.renderStats = true; }
+        else if(!strcmp(a, "--bots") && hasNext) opt.bots = atoi(argv[++i]);
+        else if(!strcmp(a, "--mode") && hasNext) {
+            opt.modeName = argv[++i];
+            if(!withWorldMode(opt.modeName, [](auto) {})) { printUsage(argv[0]); return false; }
+        }
+        else if(!strcmp(a, "--threads") && hasNext) opt.threads = atoi(argv[++i]);
+        else if(!strcmp(a, "--verify-threads") && hasNext) opt.verifyThreads = atoi(argv[++i]);
+        else if(!strcmp(a, "--grain") && hasNext) opt.grain = atoi(argv[++i]);
+        else if(!strcmp(a, "--no-ai-lod")) opt.aiLod = false;
+        else if(!strcmp(a, "--profile") && hasNext) opt.profilePath = argv[++i];
+        else if(!strcmp(a, "--record") && hasNext) { opt.recordPath = argv[++i]; opt.renderStats = true; }
+        else if(!strcmp(a, "--replay") && hasNext) opt.replayPath = argv[++i];
+        else if(!strcmp(a, "--verify-snapshot") && hasNext) opt.verifySnapshot = atoi(argv[++i]);
+        else if(!strcmp(a, "--snapshot") && hasNext) opt.snapshotPath = argv[++i];
+        else if(!strcmp(a, "--program-cache") && hasNext) { opt.programCacheDir = argv[++i]; opt.renderStats = true; }
+        else { printUsage(argv[0]); return false; }
+    }
+    return opt.matches > 0 && opt.ticks > 0 && opt.dt >= 1.0f / GameConfig::MAX_SIM_HZ &&
+           opt.dt <= 1.0f / GameConfig::MIN_SIM_HZ;
+}
+
+// Bot count and AI settings, the same for every run path.
+template<class W>
+static void configureWorld(W& w, const RunnerOptions& opt) {
+    w.botCount = opt.bots;
+    w.entities->aiLod = opt.aiLod;
+}
+
+// With an engine the pilot's input goes through it, as touch input would.
+template<class W>
+static void pilotInput(W& w, BasicGameEngine<typename W::Mode>* engine) {
+    if(!engine) { pilotInput(w); return; }
+    PilotInput in = pilot(w);
+    engine->input(in.x, in.z, in.fire, in.dash, in.ult);
+}
+
+// Lockstep determinism check across thread counts. The threaded world uses
+// a small grain (default 4 bots per job) so even 30 bots split across every
+// worker and get stolen.
+// Draws the current frame twice without ticking or camera shake. The second
+// draw repeats the first exactly, so the device's shadow state must drop
+// its useProgram and every matrix upload. Returns false if it did not.
+template<class Engine>
+static bool verifyRedundantFrame(Engine* engine) {
+    engine->getWorld()->cameraShake = 0.0f;
+    engine->step(0.0f);
+    engine->step(0.0f);
+    const FrameStats& fs = engine->getFrameStats();
+    printf("repeat_frame uniform_uploads=%d uniform_skips=%d program_skips=%d\n",
+           fs.uniformUploads, fs.uniformSkips, fs.stateSkips);
+    if(fs.uniformUploads == 0 && fs.uniformSkips > 0 && fs.stateSkips > 0) return true;
+    printf("FAIL: a repeated frame re-sent state the device already held\n");
+    return false;
+}
+
+template<class W>
+static int verifyThreads(const RunnerOptions& opt) {
+    JobSystem jobs(opt.verifyThreads);
+    W ref(opt.seed), par(opt.seed);
+    configureWorld(ref, opt);
+    configureWorld(par, opt);
+    par.setJobs(&jobs);
+    par.entities->aiGrain = opt.grain > 0 ? opt.grain : 4;
+
+    long long ticks = 0;
+    for(int m=0; m<opt.matches; m++) {
+        ref.reset(opt.seed + m);
+        par.reset(opt.seed + m);
+        for(int t=0; t<opt.ticks && ref.gameState == 0; t++, ticks++) {
+            pilotInput(ref);
+            pilotInput(par);
+            ref.update(opt.dt);
+            par.update(opt.dt);
+            if(ref.stateHash() != par.stateHash()) {
+                printf("FAIL: match %d seed=%llu diverged at tick %d with %d threads\n",
+                       m, (unsigned long long)ref.seed, t, opt.verifyThreads);
+                return 3;
+            }
+        }
+    }
+    printf("verify mode=%s threads=%d bots=%d matches=%d ticks=%lld identical\n",
+           W::Mode::NAME, opt.verifyThreads, opt.bots, opt.matches, ticks);
+    return 0;
+}
+
+// `snap` with its bot count, sim rate and game state re-encoded.
+static std::vector<uint8_t> withHeader(const std::vector<uint8_t>& snap, uint64_t bots, uint64_t hz, int64_t state) {
+    ByteReader r(snap.data(), snap.size());
+    char magic[4], name[32];
+    r.raw(magic, 4); r.u8();
+    r.raw(name, r.varint());
+    r.u64();
+    Random rng;
+    rng.load(r);
+    size_t at = snap.size() - r.remaining();
+    r.varint(); r.varint(); r.svarint();
+    size_t rest = snap.size() - r.remaining();
+    ByteWriter w;
+    w.raw(snap.data(), at);
+    w.varint(bots); w.varint(hz); w.svarint(state);
+    w.raw(snap.data() + rest, snap.size() - rest);
+    return w.bytes;
+}
+
+// `snap` claiming to come from a world of mode `name`.
+static std::vector<uint8_t> withMode(const std::vector<uint8_t>& snap, const char* name) {
+    ByteReader r(snap.data(), snap.size());
+    char magic[4], old[32];
+    r.raw(magic, 4); r.u8();
+    r.raw(old, r.varint());
+    size_t rest = snap.size() - r.remaining();
+    ByteWriter w;
+    w.raw(snap.data(), 5);
+    w.varint(strlen(name));
+    w.raw(name, strlen(name));
+    w.raw(snap.data() + rest, snap.size() - rest);
+    return w.bytes;
+}
+
+// Restores corrupted copies of `snap` into a world holding another match.
+// Damaged headers must be refused; any copy may be refused, but a refused
+// one must leave the world on its previous seed, bot count and sim rate,
+// and every world must still tick afterwards. Returns false on a failure.
+template<class W>
+static bool verifyCorruptSnapshots(const RunnerOptions& opt, const std::vector<uint8_t>& snap) {
+    W scratch(opt.seed + 1000);
+    configureWorld(scratch, opt);
+    scratch.reset(scratch.seed);
+    std::vector<std::vector<uint8_t>> mustFail;
+    for(int k=0; k<5; k++) { mustFail.push_back(snap); mustFail.back()[k] ^= 0xFF; }
+    mustFail.push_back(withMode(snap, strcmp(W::Mode::NAME, StandardMode::NAME) ? StandardMode::NAME : MobileMode::NAME));
+    mustFail.push_back(withHeader(snap, W::MAX_BOTS + 1, GameConfig::SIM_HZ, 0));
+    mustFail.push_back(withHeader(snap, opt.bots, 0, 0));
+    mustFail.push_back(withHeader(snap, opt.bots, GameConfig::MIN_SIM_HZ - 1, 0));
+    mustFail.push_back(withHeader(snap, opt.bots, GameConfig::MAX_SIM_HZ + 1, 0));
+    mustFail.push_back(withHeader(snap, opt.bots, GameConfig::SIM_HZ, 3));
+    mustFail.push_back(withHeader(snap, opt.bots, GameConfig::SIM_HZ, -1));
+
+    size_t stride = snap.size() > 4096 ? snap.size() / 4096 : 1;
+    int tried = 0, refused = 0;
+    for(size_t k=0; k<mustFail.size() + snap.size(); k += k < mustFail.size() ? 1 : stride) {
+        std::vector<uint8_t> bad(k < mustFail.size() ? mustFail[k] : snap);
+        if(k >= mustFail.size()) bad[k - mustFail.size()] ^= 0xFF;
+        uint64_t seed = scratch.seed;
+        int bots = scratch.botCount, hz = scratch.simRate();
+        ByteReader r(bad.data(), bad.size());
+        bool ok = scratch.load(r);
+        tried++;
+        if(!ok) {
+            refused++;
+            if(scratch.seed != seed || scratch.botCount != bots || scratch.simRate() != hz) {
+                printf("FAIL: corrupt snapshot %zu refused but left seed/bots/sim rate changed\n", k);
+                return false;
+            }
+        } else if(k < mustFail.size()) {
+            printf("FAIL: corrupt snapshot header case %zu was accepted\n", k);
+            return false;
+        }
+        for(int t=0; t<3; t++) scratch.update(opt.dt);
+        if(ok) { scratch.botCount = bots; scratch.setSimRate(hz); scratch.reset(seed); }
+    }
+
+    // Particle ring headers, too deep in the stream to patch: capacities
+    // that aren't a power of two, are too small or too big (2^32 truncates
+    // to 0 as an int), and counts over the capacity.
+    const uint64_t ringHeaders[][2] = { { 17, 0 }, { 8, 0 }, { (uint64_t)ParticleSystem::MAX_CAPACITY * 2, 0 },
+                                        { 1ull << 30, 0 }, { 1ull << 31, 0 }, { 1ull << 32, 0 }, { 16, 17 } };
+    ParticleSystem ring;
+    ring.resize(GameConfig::PARTICLE_SLOTS);
+    for(const auto& h : ringHeaders) {
+        ByteWriter w;
+        w.varint(h[0]); w.varint(h[1]);
+        w.bytes.resize(w.bytes.size() + 64 * 41);
+        ByteReader r(w.bytes.data(), w.bytes.size());
+        if(ring.load(r) || ring.capacity() != GameConfig::PARTICLE_SLOTS) {
+            printf("FAIL: particle ring header capacity=%llu count=%llu was accepted\n",
+                   (unsigned long long)h[0], (unsigned long long)h[1]);
+            return false;
+        }
+    }
+    printf("verify corrupt_snapshots=%d refused=%d header_cases=%zu ring_header_cases=%zu\n",
+           tried, refused, mustFail.size(), sizeof(ringHeaders) / sizeof(ringHeaders[0]));
+    return true;
+}
+
+// Save/restore round trip per match. The restoring world is reused and
+// still holds the previous match, so a restore has to overwrite everything.
+template<class W>
+static int verifySnapshot(const RunnerOptions& opt) {
+    W ref(opt.seed), copy(opt.seed);
+    configureWorld(ref, opt);
+    configureWorld(copy, opt);
+
+    long long ticks = 0;
+    size_t bytes = 0;
+    double saveUs = 0.0, restoreUs = 0.0, worstSaveUs = 0.0, worstRestoreUs = 0.0;
+    for(int m=0; m<opt.matches; m++) {
+        ref.reset(opt.seed + m);
+        int t = 0;
+        for(; t<opt.verifySnapshot && ref.gameState == 0; t++) {
+            pilotInput(ref);
+            ref.update(opt.dt);
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        ByteWriter snap;
+        ref.save(snap);
+        auto t1 = std::chrono::steady_clock::now();
+        std::vector<uint8_t> file;
+        if(opt.snapshotPath && m == 0) {
+            if(!snap.save(opt.snapshotPath) || !readFile(opt.snapshotPath, file)) {
+                printf("FAIL: could not write %s\n", opt.snapshotPath);
+                return 1;
+            }
+        } else {
+            file.swap(snap.bytes);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        ByteReader r(file.data(), file.size());
+        const char* error = "";
+        bool ok = copy.load(r, &error) && r.remaining() == 0;
+        auto t3 = std::chrono::steady_clock::now();
+        if(!ok) {
+            printf("FAIL: match %d restore: %s\n", m, error);
+            return 3;
+        }
+        if(m == 0 && !verifyCorruptSnapshots<W>(opt, file)) return 3;
+
+        double s = std::chrono::duration<double, std::micro>(t1 - t0).count();
+        double l = std::chrono::duration<double, std::micro>(t3 - t2).count();
+        saveUs += s; restoreUs += l;
+        if(s > worstSaveUs) worstSaveUs = s;
+        if(l > worstRestoreUs) worstRestoreUs = l;
+        bytes += file.size();
+
+        for(;; t++, ticks++) {
+            if(ref.stateHash() != copy.stateHash()) {
+                printf("FAIL: match %d seed=%llu diverged at tick %d after a snapshot at tick %d\n",
+                       m, (unsigned long long)ref.seed, t, opt.verifySnapshot);
+                return 3;
+            }
+            if(t >= opt.ticks || ref.gameState != 0) break;
+            pilotInput(ref);
+            pilotInput(copy);
+            ref.update(opt.dt);
+            copy.update(opt.dt);
+        }
+    }
+    printf("verify mode=%s snapshot_tick=%d bots=%d matches=%d ticks_after=%lld identical\n",
+           W::Mode::NAME, opt.verifySnapshot, opt.bots, opt.matches, ticks);
+    printf("snapshot bytes_avg=%.0f save_us_avg=%.1f save_us_max=%.1f restore_us_avg=%.1f restore_us_max=%.1f\n",
+           (double)bytes / opt.matches, saveUs / opt.matches, worstSaveUs, restoreUs / opt.matches, worstRestoreUs);
+    return 0;
+}
+
+template<class W>
+static int replayFile(const RunnerOptions& opt, Replay& replay) {
+    JobSystem jobs(opt.threads);
+    W world(replay.seed);
+    if(opt.threads > 1) world.setJobs(&jobs);
+    printf("replay file=%s bytes=%zu seed=%llu sim_hz=%d mode=%s ai_lod=%s bots=%d steps=%lld ticks=%lld hash_interval=%d\n",
+           opt.replayPath, replay.data.size(), (unsigned long long)replay.seed, replay.simHz, replay.mode.c_str(),
+           replay.aiLod ? "on" : "off", replay.botCount,
+           replay.steps, replay.ticks, replay.hashInterval);
+
+    double best = 0.0, total = 0.0;
+    uint64_t firstHash = 0;
+    for(int run=0; run<opt.matches; run++) {
+        ReplayResult res = replay.run(world);
+        if(res.divergedAt >= 0) {
+            printf("FAIL: run %d diverged at tick %lld of %lld\n", run, res.divergedAt, replay.ticks);
+            return 3;
+        }
+        if(run == 0) firstHash = res.finalHash;
+        else if(res.finalHash != firstHash) {
+            printf("FAIL: run %d final hash %016llx differs from run 0\n", run, (unsigned long long)res.finalHash);
+            return 3;
+        }
+        double tps = res.seconds > 0.0 ? res.ticks / res.seconds : 0.0;
+        if(tps > best) best = tps;
+        total += res.seconds;
+    }
+    printf("replay runs=%d state=%d final_hash=%016llx identical ticks_per_s_best=%.0f ticks_per_s_avg=%.0f\n",
+           opt.matches, world.gameState, (unsigned long long)firstHash, best,
+           total > 0.0 ? replay.ticks * opt.matches / total : 0.0);
+    return 0;
+}
+
+static int replayFile(const RunnerOptions& opt) {
+    Replay replay;
+    if(!replay.load(opt.replayPath)) {
+        printf("FAIL: %s: %s\n", opt.replayPath, replay.error);
+        return 1;
+    }
+    int rc = 1;
+    withWorldMode(replay.mode.c_str(), [&](auto mode) { rc = replayFile<BasicWorld<decltype(mode)>>(opt, replay); });
+    return rc;
+}
+
+template<class Mode>
+static int run(RunnerOptions opt) {
+    typedef BasicWorld<Mode> WorldType;
+    typedef BasicGameEngine<Mode> Engine;
+    if(opt.bots <= 0) opt.bots = Mode::BOTS;
+    if(opt.bots > WorldType::MAX_BOTS) {
+        printf("FAIL: %s mode holds at most %d bots\n", Mode::NAME, WorldType::MAX_BOTS);
+        return 1;
+    }
+    if(opt.verifyThreads > 0) return verifyThreads<WorldType>(opt);
+    if(opt.verifySnapshot >= 0) return verifySnapshot<WorldType>(opt);
+    if(opt.profilePath) {
+        if(!PROFILER_ENABLED) { printf("profiler compiled out (ENABLE_PROFILER=OFF)\n"); return 1; }
+        Profiler::get().setEnabled(true);
+    }
+
+    int wins = 0, losses = 0, timeouts = 0;
+    long long totalTicks = 0;
+    double simSeconds = 0.0;
+
+    RecordingDevice device(false);
+    Engine* engine = NULL;
+    WorldType* world;
+    if(opt.renderStats) {
+        engine = new Engine(&device, opt.seed);
+        ProgramCache programs(opt.programCacheDir ? opt.programCacheDir : "");
+        if(!engine->init(opt.programCacheDir ? &programs : NULL)) {
+            printf("FAIL: shader: %s\n", engine->getShaderError().c_str());
+            return 1;
+        }
+        if(opt.programCacheDir) {
+            printf("program_cache dir=%s source=%s hits=%d misses=%d rejected=%d writes=%d\n", opt.programCacheDir,
+                   engine->shaderFromCache() ? "binary" : "compiled", programs.hits, programs.misses, programs.rejected, programs.writes);
+        }
+        engine->resize(1280, 720);
+        engine->setSimRate((int)lroundf(1.0f / opt.dt));
+        world = engine->getWorld();
+    } else {
+        world = new WorldType(opt.seed);
+    }
+    JobSystem jobs(opt.threads);
+    configureWorld(*world, opt);
+    if(opt.threads > 1) world->setJobs(&jobs);
+    if(opt.grain > 0) world->entities->aiGrain = opt.grain;
+    long long tierBots[AI_TIER_COUNT] = {0}, scans = 0, navRebuilds = 0, losRays = 0, losCached = 0;
+
+    const float frameDt = opt.fps > 0 ? 1.0f / opt.fps : opt.dt;
+    long long frames = 0, draws = 0, uniforms = 0, uniformSkips = 0, stateSkips = 0, attribs = 0, bytes = 0;
+    long long visible[CULL_SET_COUNT] = {0}, culled[CULL_SET_COUNT] = {0};
+    int maxDraws = 0;
+    InputRecorder recorder;
+
+    // Match m always uses seed + m, so any single match can be re-run alone.
+    for(int m=0; m<opt.matches; m++) {
+        world->reset(opt.seed + m);
+        if(opt.recordPath && m == 0) engine->startRecording(&recorder);
+        int t = 0;
+        auto start = std::chrono::steady_clock::now();
+        while(t<opt.ticks && world->gameState == 0) {
+            pilotInput(*world, engine);
+            if(engine) {
+                t += engine->step(frameDt);
+                const FrameStats& fs = engine->getFrameStats();
+                frames++;
+                draws += fs.drawCalls; uniforms += fs.uniformUploads;
+                uniformSkips += fs.uniformSkips; stateSkips += fs.stateSkips;
+                attribs += fs.attribBinds; bytes += fs.bytesSubmitted;
+                if(fs.drawCalls > maxDraws) maxDraws = fs.drawCalls;
+                const CullStats& cs = engine->getCullStats();
+                for(int c=0; c<CULL_SET_COUNT; c++) { visible[c] += cs.visible[c]; culled[c] += cs.culled[c]; }
+            } else {
+                Profiler::get().beginFrame();
+                world->update(opt.dt);
+                t++;
+            }
+            const AiStats& ls = world->entities->aiStats;
+            for(int k=0; k<AI_TIER_COUNT; k++) tierBots[k] += ls.bots[k];
+            scans += ls.scans;
+            losRays += ls.losRays; losCached += ls.losCached;
+            world->entities->consumeKillEvent();
+            world->weapons->consumeShootEvent();
+        }
+        auto end = std::chrono::steady_clock::now();
+        simSeconds += std::chrono::duration<double>(end - start).count();
+        totalTicks += t;
+        navRebuilds += world->entities->nav.rebuilds;
+        world->entities->nav.rebuilds = 0;
+
+        if(world->gameState == 1) wins++;
+        else if(world->gameState == 2) losses++;
+        else timeouts++;
+
+        if(opt.recordPath && m == 0) {
+            engine->stopRecording();
+            if(!recorder.save(opt.recordPath)) {
+                printf("FAIL: could not write %s\n", opt.recordPath);
+                return 1;
+            }
+            ByteWriter file;
+            recorder.write(file);
+            // Uncompressed: seed plus two floats, three bools and a float dt per step.
+            long long raw = 8 + recorder.steps * (4 * 3 + 3);
+            printf("record file=%s steps=%lld ticks=%lld bytes=%zu bytes_per_step=%.2f raw_bytes=%lld\n",
+                   opt.recordPath, recorder.steps, recorder.ticks, file.bytes.size(),
+                   (double)file.bytes.size() / recorder.steps, raw);
+        }
+
+        if(opt.verbose) {
+            printf("match %d: seed=%llu state=%d ticks=%d hp=%d botsAlive=%d\n",
+                   m, (unsigned long long)world->seed, world->gameState, t, (int)world->player->hp, world->entities->botsAlive);
+        }
+    }
+    bool repeatOk = !engine || verifyRedundantFrame(engine);
+    if(engine) delete engine; else delete world;
+
+    double tps = simSeconds > 0.0 ? totalTicks / simSeconds : 0.0;
+    if(opt.verbose) printf("mode=%s map_size=%d bots=%d\n", Mode::NAME, Mode::MAP_SIZE, opt.bots);
+    printf("matches=%d wins=%d losses=%d timeouts=%d ticks=%lld sim_s=%.3f ticks_per_s=%.0f\n",
+           opt.matches, wins, losses, timeouts, totalTicks, simSeconds, tps);
+    if(totalTicks > 0) {
+        printf("ai_lod=%s full_per_tick=%.2f mid_per_tick=%.2f far_per_tick=%.2f scans_per_tick=%.2f\n",
+               opt.aiLod ? "on" : "off", (double)tierBots[AI_FULL] / totalTicks, (double)tierBots[AI_MID] / totalTicks,
+               (double)tierBots[AI_FAR] / totalTicks, (double)scans / totalTicks);
+        printf("los rays_per_tick=%.2f cached_per_tick=%.2f cache_hit_rate=%.2f\n",
+               (double)losRays / totalTicks, (double)losCached / totalTicks,
+               losRays + losCached > 0 ? (double)losCached / (losRays + losCached) : 0.0);
+        printf("nav rebuilds=%lld rebuilds_per_1k_ticks=%.1f\n", navRebuilds, navRebuilds * 1000.0 / totalTicks);
+    }
+
+    if(frames > 0) {
+        printf("frames=%lld ticks_per_frame=%.2f draws_per_frame=%.2f max_draws=%d uniforms_per_frame=%.2f "
+               "uniform_skips_per_frame=%.2f program_skips_per_frame=%.2f attribs_per_frame=%.2f bytes_per_frame=%.0f\n",
+               frames, (double)totalTicks / frames, (double)draws / frames, maxDraws, (double)uniforms / frames,
+               (double)uniformSkips / frames, (double)stateSkips / frames, (double)attribs / frames, (double)bytes / frames);
+        const char* setNames[CULL_SET_COUNT] = { "wall_chunks", "characters", "particles", "bullets" };
+        for(int c=0; c<CULL_SET_COUNT; c++) {
+            printf("cull %s visible_per_frame=%.2f culled_per_frame=%.2f\n",
+                   setNames[c], (double)visible[c] / frames, (double)culled[c] / frames);
+        }
+    }
+
+    if(opt.profilePath) {
+        Profiler::get().setEnabled(false);
+        printf("profile %s\n", Profiler::get().summaryJson().c_str());
+        if(!Profiler::get().writeChromeTrace(opt.profilePath)) {
+            printf("FAIL: could not write %s\n", opt.profilePath);
+            return 1;
+        }
+    }
+
+    if(opt.maxDrawCalls > 0 && maxDraws > opt.maxDrawCalls) {
+        printf("FAIL: %d draw calls in one frame exceeds limit %d\n", maxDraws, opt.maxDrawCalls);
+        return 2;
+    }
+    if(!repeatOk) return 2;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    RunnerOptions opt;
+    if(!parseArgs(argc, argv, opt)) return 1;
+    if(opt.replayPath && opt.verifyThreads <= 0) return replayFile(opt);
+    int rc = 1;
+    withWorldMode(opt.modeName, [&](auto mode) { rc = run<decltype(mode)>(opt); });
+    return rc;
+}